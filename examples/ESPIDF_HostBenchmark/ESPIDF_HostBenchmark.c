@@ -0,0 +1,291 @@
+/*
+
+  ESP-IDF Host Benchmark
+
+  Measures the speed of the functions which encode and decode RDM packets. These
+  functions run on every RDM packet and some of them run inside the DMX
+  interrupt service routine. Each function is benchmarked with the parameter
+  data of a few representative RDM parameters. Results are printed as one JSON
+  object per line so that they can be saved and compared between commits. The
+  throughput is the size of the encoded RDM packet divided by the time that one
+  call to the function took. The merge engine is also benchmarked by merging
+  four sources of 512 slots each, which is done before every DMX packet that is
+  sent while sources are merged. Its throughput is the size of the merged
+  sources divided by the time that one merge took. On the ESP-IDF linux target,
+  the number of UART and timer interrupts that the receiving DMX port handles
+  per DMX packet is also counted for a full and a short DMX packet.
+
+  Note: this example is intended for the ESP-IDF linux target but it may also
+  be run on an ESP32. Set the target using `idf.py --preview set-target linux`
+  before building. It will not work on Arduino!
+
+  Created 15 October 2026
+  By Mitch Weisbrod
+
+  https://github.com/someweisguy/esp_dmx
+
+*/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "dmx/include/service.h"
+#include "esp_dmx.h"
+#ifdef CONFIG_IDF_TARGET_LINUX
+#include "dmx/sim.h"
+#endif
+#include "rdm/include/driver.h"
+
+static const dmx_port_t dmx_num = DMX_NUM_0;
+
+/* Each benchmark is run for at least this long so that the clock resolution
+ * does not affect the results.*/
+static const int64_t min_duration_ns = 200000000;
+
+typedef struct benchmark_t {
+  const char *name;     // The name of the RDM parameter.
+  const char *format;   // The parameter data format string.
+  rdm_header_t header;  // The header of the RDM packet.
+  const void *pd;       // The parameter data of the RDM packet.
+  size_t pd_size;       // The size of the parameter data buffer.
+} benchmark_t;
+
+typedef enum benchmark_op_t {
+  BENCHMARK_OP_FORMAT_IS_VALID,
+  BENCHMARK_OP_WRITE,
+  BENCHMARK_OP_READ_HEADER,
+  BENCHMARK_OP_READ_PD,
+} benchmark_op_t;
+
+static int64_t get_time_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static size_t run_op(benchmark_op_t op, const benchmark_t *benchmark,
+                     uint32_t iterations) {
+  rdm_header_t header;
+  uint8_t pd[RDM_PD_SIZE_MAX];
+  size_t size = 0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    switch (op) {
+      case BENCHMARK_OP_FORMAT_IS_VALID:
+        size += rdm_format_is_valid(benchmark->format);
+        break;
+      case BENCHMARK_OP_WRITE:
+        size += rdm_write(dmx_num, &benchmark->header, benchmark->format,
+                          benchmark->pd);
+        break;
+      case BENCHMARK_OP_READ_HEADER:
+        size += rdm_read_header(dmx_num, &header);
+        break;
+      case BENCHMARK_OP_READ_PD:
+        size += rdm_read_pd(dmx_num, benchmark->format, pd, sizeof(pd));
+        break;
+    }
+  }
+  return size;
+}
+
+static void benchmark(benchmark_op_t op, const char *op_name,
+                      const benchmark_t *benchmark) {
+  // The packet size is used to calculate the throughput
+  const size_t packet_size =
+      rdm_write(dmx_num, &benchmark->header, benchmark->format, benchmark->pd);
+
+  // Increase the number of iterations until the minimum duration is reached
+  uint32_t iterations = 1000;
+  int64_t duration;
+  while (true) {
+    const int64_t start = get_time_ns();
+    run_op(op, benchmark, iterations);
+    duration = get_time_ns() - start;
+    if (duration >= min_duration_ns) {
+      break;
+    }
+    iterations *= 2;
+  }
+
+  const double ns_per_op = (double)duration / iterations;
+  printf("{\"function\": \"%s\", \"parameter\": \"%s\", \"iterations\": %" PRIu32
+         ", \"ns_per_op\": %.2f, \"bytes_per_s\": %.0f}\n",
+         op_name, benchmark->name, iterations, ns_per_op,
+         packet_size * 1e9 / ns_per_op);
+}
+
+static void benchmark_merge(void) {
+  // Write a full universe to every merge source so that every slot is merged
+  uint8_t data[DMX_PACKET_SIZE];
+  for (int i = 0; i < DMX_MERGE_SOURCE_MAX; ++i) {
+    for (int j = 0; j < DMX_PACKET_SIZE; ++j) {
+      data[j] = (j * (i + 3)) & 0xff;
+    }
+    dmx_merge_write(dmx_num, i, 0, data, DMX_PACKET_SIZE);
+  }
+  const size_t merge_size = (DMX_PACKET_SIZE - 1) * DMX_MERGE_SOURCE_MAX;
+
+  // Increase the number of iterations until the minimum duration is reached
+  uint32_t iterations = 1000;
+  int64_t duration;
+  while (true) {
+    const int64_t start = get_time_ns();
+    for (uint32_t i = 0; i < iterations; ++i) {
+      dmx_merge_update(dmx_num);
+    }
+    duration = get_time_ns() - start;
+    if (duration >= min_duration_ns) {
+      break;
+    }
+    iterations *= 2;
+  }
+
+  const double ns_per_op = (double)duration / iterations;
+  printf("{\"function\": \"dmx_merge_update\", \"parameter\": \"512x%d\", "
+         "\"iterations\": %" PRIu32
+         ", \"ns_per_op\": %.2f, \"bytes_per_s\": %.0f}\n",
+         DMX_MERGE_SOURCE_MAX, iterations, ns_per_op,
+         merge_size * 1e9 / ns_per_op);
+
+  for (int i = 0; i < DMX_MERGE_SOURCE_MAX; ++i) {
+    dmx_merge_release(dmx_num, i);
+  }
+}
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+static void benchmark_isr(dmx_port_t rx_num, size_t size) {
+  const int frame_count = 100;
+  dmx_packet_t packet;
+
+  // Receive a few packets first so that the receiver learns the packet size
+  for (int i = 0; i < 2; ++i) {
+    dmx_send_num(dmx_num, size);
+    dmx_receive(rx_num, &packet, DMX_TIMEOUT_TICK);
+  }
+  dmx_sim_reset_stats(rx_num);
+
+  int frames = 0;
+  for (int i = 0; i < frame_count; ++i) {
+    dmx_send_num(dmx_num, size);
+    if (dmx_receive(rx_num, &packet, DMX_TIMEOUT_TICK) > 0 &&
+        packet.err == DMX_OK) {
+      ++frames;
+    }
+  }
+
+  dmx_sim_stats_t stats;
+  dmx_sim_get_stats(rx_num, &stats);
+  printf("{\"function\": \"dmx_receive\", \"parameter\": \"%zu slots\", "
+         "\"frames\": %d, \"uart_isrs_per_frame\": %.2f, "
+         "\"timer_isrs_per_frame\": %.2f}\n",
+         size, frames, (double)stats.uart_isr_count / frame_count,
+         (double)stats.timer_isr_count / frame_count);
+}
+#endif
+
+void app_main() {
+  dmx_config_t config = DMX_CONFIG_DEFAULT;
+  dmx_driver_install(dmx_num, &config, NULL, 0);
+
+  const rdm_uid_t controller_uid = {0x05e0, 0x12345678};
+  const rdm_uid_t responder_uid = {0x05e0, 0x87654321};
+
+  const rdm_device_info_t device_info = {.model_id = 0x1234,
+                                         .product_category =
+                                             RDM_PRODUCT_CATEGORY_FIXTURE,
+                                         .software_version_id = 0x01020304,
+                                         .footprint = 16,
+                                         .personality = {1, 3},
+                                         .dmx_start_address = 1,
+                                         .sub_device_count = 0,
+                                         .sensor_count = 1};
+
+  const rdm_sensor_definition_t sensor_definition = {
+      .num = 0,
+      .type = RDM_SENSOR_TYPE_TEMPERATURE,
+      .unit = RDM_UNITS_CENTIGRADE,
+      .prefix = RDM_PREFIX_NONE,
+      .range = {-40, 125},
+      .normal = {0, 85},
+      .recorded_value_support = 1,
+      .lowest_highest_detected_value_support = 1,
+      .description = "Internal Temperature"};
+
+  uint16_t supported_parameters[115];
+  for (int i = 0; i < 115; ++i) {
+    supported_parameters[i] = 0x8000 + i;
+  }
+
+  const benchmark_t benchmarks[] = {
+      {.name = "DEVICE_INFO",
+       .format = "x01x00wwdwbbwwb$",
+       .header = {.message_len = 24 + sizeof(device_info),
+                  .dest_uid = controller_uid,
+                  .src_uid = responder_uid,
+                  .response_type = RDM_RESPONSE_TYPE_ACK,
+                  .cc = RDM_CC_GET_COMMAND_RESPONSE,
+                  .pid = RDM_PID_DEVICE_INFO,
+                  .pdl = sizeof(device_info)},
+       .pd = &device_info,
+       .pd_size = sizeof(device_info)},
+      {.name = "SENSOR_DEFINITION",
+       .format = "bbbbwwwwba",
+       .header = {.message_len = 24 + sizeof(sensor_definition),
+                  .dest_uid = controller_uid,
+                  .src_uid = responder_uid,
+                  .response_type = RDM_RESPONSE_TYPE_ACK,
+                  .cc = RDM_CC_GET_COMMAND_RESPONSE,
+                  .pid = RDM_PID_SENSOR_DEFINITION,
+                  .pdl = sizeof(sensor_definition)},
+       .pd = &sensor_definition,
+       .pd_size = sizeof(sensor_definition)},
+      {.name = "SUPPORTED_PARAMETERS",
+       .format = "w",
+       .header = {.message_len = 24 + sizeof(supported_parameters),
+                  .dest_uid = controller_uid,
+                  .src_uid = responder_uid,
+                  .response_type = RDM_RESPONSE_TYPE_ACK,
+                  .cc = RDM_CC_GET_COMMAND_RESPONSE,
+                  .pid = RDM_PID_SUPPORTED_PARAMETERS,
+                  .pdl = sizeof(supported_parameters)},
+       .pd = supported_parameters,
+       .pd_size = sizeof(supported_parameters)},
+      {.name = "DISC_UNIQUE_BRANCH",
+       .format = NULL,
+       .header = {.message_len = 24,
+                  .dest_uid = RDM_UID_BROADCAST_ALL,
+                  .src_uid = responder_uid,
+                  .response_type = RDM_RESPONSE_TYPE_ACK,
+                  .cc = RDM_CC_DISC_COMMAND_RESPONSE,
+                  .pid = RDM_PID_DISC_UNIQUE_BRANCH,
+                  .pdl = 0},
+       .pd = NULL,
+       .pd_size = 0},
+  };
+
+  const int benchmark_count = sizeof(benchmarks) / sizeof(benchmark_t);
+  for (int i = 0; i < benchmark_count; ++i) {
+    const benchmark_t *b = &benchmarks[i];
+    if (b->format != NULL) {
+      benchmark(BENCHMARK_OP_FORMAT_IS_VALID, "rdm_format_is_valid", b);
+    }
+    benchmark(BENCHMARK_OP_WRITE, "rdm_write", b);
+    benchmark(BENCHMARK_OP_READ_HEADER, "rdm_read_header", b);
+    if (b->pd_size > 0) {
+      benchmark(BENCHMARK_OP_READ_PD, "rdm_read_pd", b);
+    }
+  }
+  benchmark_merge();
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+  // Count the interrupts that are handled per received DMX packet
+  const dmx_port_t rx_num = DMX_NUM_1;
+  dmx_driver_install(rx_num, &config, NULL, 0);
+  benchmark_isr(rx_num, DMX_PACKET_SIZE);
+  benchmark_isr(rx_num, 100);
+  dmx_driver_delete(rx_num);
+#endif
+
+  dmx_driver_delete(dmx_num);
+}
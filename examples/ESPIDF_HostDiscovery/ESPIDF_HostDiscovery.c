@@ -0,0 +1,90 @@
+/*
+
+  ESP-IDF Host Discovery
+
+  Runs RDM discovery on the host machine against networks of emulated RDM
+  responders of increasing size. The emulated responders are connected to the
+  virtual RS-485 bus of the host HAL and their responses to discovery requests
+  collide the same way they would on a real DMX line. For each network size,
+  the time that discovery took on the virtual bus and the number of RDM
+  transactions that were needed are logged.
+
+  Note: this example is for use with the ESP-IDF linux target. Set the target
+  using `idf.py --preview set-target linux` before building. It will not work
+  on Arduino!
+
+  Created 15 October 2026
+  By Mitch Weisbrod
+
+  https://github.com/someweisguy/esp_dmx
+
+*/
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "dmx/sim.h"
+#include "esp_dmx.h"
+#include "esp_log.h"
+#include "rdm/controller.h"
+
+static const char *TAG = "main";
+
+static const dmx_port_t dmx_num = DMX_NUM_0;
+
+static const int network_sizes[] = {1, 10, 100, 500, 1000, 2000, 4000};
+
+static uint32_t random_uint32(uint32_t *state) {
+  // Xorshift generates the same UIDs each time the example is run
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+void app_main() {
+  dmx_config_t config = DMX_CONFIG_DEFAULT;
+  dmx_driver_install(dmx_num, &config, NULL, 0);
+
+  const int network_size_count = sizeof(network_sizes) / sizeof(int);
+  const int max_network_size = network_sizes[network_size_count - 1];
+  rdm_uid_t *uids = malloc(sizeof(rdm_uid_t) * max_network_size);
+  if (uids == NULL) {
+    ESP_LOGE(TAG, "Could not allocate UIDs.");
+    return;
+  }
+
+  ESP_LOGI(TAG, "responders, found, time_us, requests, disc_unique_branch, "
+                "disc_mute, collisions");
+  for (int i = 0; i < network_size_count; ++i) {
+    const int network_size = network_sizes[i];
+
+    // Create a network of emulated responders with random UIDs
+    uint32_t state = 0x2545f491;
+    for (int j = 0; j < network_size; ++j) {
+      uids[j].man_id = (random_uint32(&state) % 0x7fff) + 1;
+      uids[j].dev_id = random_uint32(&state) % 0xffffffff;
+    }
+    dmx_sim_remove_responders();
+    dmx_sim_add_responders(uids, network_size);
+
+    // Discover the network
+    dmx_sim_reset_rdm_stats();
+    const int64_t start = dmx_sim_get_time();
+    const int devices_found = rdm_discover_devices_simple(dmx_num, NULL, 0);
+    const int64_t duration = dmx_sim_get_time() - start;
+
+    dmx_sim_rdm_stats_t stats;
+    dmx_sim_get_rdm_stats(&stats);
+    ESP_LOGI(TAG, "%i, %i, %" PRIi64 ", %" PRIu32 ", %" PRIu32 ", %" PRIu32
+             ", %" PRIu32, network_size, devices_found, duration,
+             stats.requests, stats.disc_unique_branch, stats.disc_mute,
+             stats.collisions);
+    if (devices_found != network_size) {
+      ESP_LOGW(TAG, "Discovery found %i of %i responders.", devices_found,
+               network_size);
+    }
+  }
+
+  free(uids);
+  dmx_sim_remove_responders();
+}
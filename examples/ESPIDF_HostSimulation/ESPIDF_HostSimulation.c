@@ -0,0 +1,111 @@
+/*
+
+  ESP-IDF Host Simulation
+
+  Runs a DMX controller and an RDM responder on the host machine. Both DMX
+  ports are connected to the virtual RS-485 bus of the host HAL. The controller
+  sends DMX packets to the responder, then runs RDM discovery and sends an RDM
+  request. The time each step took on the virtual bus and the number of
+  interrupts that were serviced are logged.
+
+  Note: this example is for use with the ESP-IDF linux target. Set the target
+  using `idf.py --preview set-target linux` before building. It will not work
+  on Arduino!
+
+  Created 15 October 2026
+  By Mitch Weisbrod
+
+  https://github.com/someweisguy/esp_dmx
+
+*/
+#include <inttypes.h>
+#include <string.h>
+
+#include "dmx/sim.h"
+#include "esp_dmx.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "rdm/controller.h"
+#include "rdm/responder.h"
+
+static const char *TAG = "main";
+
+static const dmx_port_t controller_num = DMX_NUM_0;
+static const dmx_port_t responder_num = DMX_NUM_1;
+
+void responder_task(void *arg) {
+  // Continuously handle DMX and RDM packets
+  dmx_packet_t packet;
+  while (1) {
+    if (dmx_receive(responder_num, &packet, DMX_TIMEOUT_TICK)) {
+      if (packet.is_rdm) {
+        rdm_send_response(responder_num);
+      }
+    }
+  }
+}
+
+void log_stats(const char *step, int64_t start) {
+  dmx_sim_stats_t controller, responder;
+  dmx_sim_get_stats(controller_num, &controller);
+  dmx_sim_get_stats(responder_num, &responder);
+  ESP_LOGI(TAG, "%s took %" PRIi64 " us (controller ISRs: %" PRIu32
+           ", responder ISRs: %" PRIu32 ")",
+           step, dmx_sim_get_time() - start,
+           controller.uart_isr_count + controller.timer_isr_count,
+           responder.uart_isr_count + responder.timer_isr_count);
+  dmx_sim_reset_stats(controller_num);
+  dmx_sim_reset_stats(responder_num);
+}
+
+void app_main() {
+  dmx_config_t config = DMX_CONFIG_DEFAULT;
+  dmx_personality_t personalities[] = {
+    {1, "Default Personality"}
+  };
+  const int personality_count = 1;
+  dmx_driver_install(controller_num, &config, NULL, 0);
+  dmx_driver_install(responder_num, &config, personalities, personality_count);
+
+  // The responder task must have a higher priority than the virtual bus
+  xTaskCreate(responder_task, "responder", 4096, NULL, 2, NULL);
+
+  // Send a DMX packet and verify that it was received by the responder
+  uint8_t data[DMX_PACKET_SIZE] = {DMX_SC};
+  for (int i = 1; i < DMX_PACKET_SIZE; ++i) {
+    data[i] = i;
+  }
+  int64_t start = dmx_sim_get_time();
+  dmx_write(controller_num, data, DMX_PACKET_SIZE);
+  dmx_send_num(controller_num, DMX_PACKET_SIZE);
+  dmx_wait_sent(controller_num, DMX_TIMEOUT_TICK);
+  vTaskDelay(1);  // Allow the responder to process the packet
+  log_stats("DMX packet", start);
+
+  uint8_t received[DMX_PACKET_SIZE];
+  dmx_read(responder_num, received, DMX_PACKET_SIZE);
+  if (memcmp(data, received, DMX_PACKET_SIZE) != 0) {
+    ESP_LOGE(TAG, "DMX packet was not received correctly!");
+  }
+
+  // Discover the responder
+  rdm_uid_t uids[4];
+  start = dmx_sim_get_time();
+  const int devices_found = rdm_discover_devices_simple(controller_num, uids, 4);
+  log_stats("RDM discovery", start);
+  if (devices_found == 0) {
+    ESP_LOGE(TAG, "Could not find any RDM capable devices.");
+    return;
+  }
+  ESP_LOGI(TAG, "Found a device with UID " UIDSTR, UID2STR(uids[0]));
+
+  // Send an RDM request to the responder
+  rdm_device_info_t device_info;
+  rdm_ack_t ack;
+  start = dmx_sim_get_time();
+  if (!rdm_send_get_device_info(controller_num, &uids[0], RDM_SUB_DEVICE_ROOT,
+                                &device_info, &ack)) {
+    ESP_LOGE(TAG, "RDM request was not answered!");
+  }
+  log_stats("RDM request", start);
+}
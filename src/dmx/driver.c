@@ -2,7 +2,7 @@
 
 #include <string.h>
 
-#include "dmx/hal/include/gpio.h"
+#include "dmx/hal/include/hal.h"
 #include "dmx/hal/include/nvs.h"
 #include "dmx/hal/include/timer.h"
 #include "dmx/hal/include/uart.h"
@@ -12,7 +12,7 @@
 #include "rdm/include/types.h"
 #include "rdm/responder/include/utils.h"
 
-#if ESP_IDF_VERSION_MAJOR >= 5
+#if ESP_IDF_VERSION_MAJOR >= 5 && !defined(CONFIG_IDF_TARGET_LINUX)
 #include "esp_mac.h"  // TODO: Make this hardware agnostic
 #endif
 
@@ -67,6 +67,11 @@ static void rdm_default_identify_cb(dmx_port_t dmx_num, rdm_header_t *request,
   }
 }
 
+static uint32_t dmx_get_rx_timeout_len(uint32_t baud_rate) {
+  // Each DMX slot is 11 bits: 1 start bit, 8 data bits, and 2 stop bits
+  return (DMX_UART_TIMEOUT_DEFAULT * 11 * 1000000) / baud_rate;
+}
+
 bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
                         const dmx_personality_t *personalities,
                         int personality_count) {
@@ -76,6 +81,9 @@ bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
             "personality_count error");
   DMX_CHECK(!dmx_driver_is_installed(dmx_num), false,
             "driver is already installed");
+  const dmx_hal_t *hal = config->hal != NULL ? config->hal : &dmx_hal_default;
+  DMX_CHECK(hal->uart != NULL && hal->timer != NULL && hal->gpio != NULL,
+            false, "hal error");
   bool uses_dmx = false;
   for (int i = 0; i < personality_count; ++i) {
     DMX_CHECK((personalities[i].footprint > 0 &&
@@ -116,6 +124,9 @@ bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
   DMX_CHECK(driver != NULL, false, "DMX driver malloc error");
   dmx_driver[dmx_num] = driver;
   driver->mux = NULL;
+  driver->dmx.staged.mux = NULL;
+  driver->dmx.fade_mux = NULL;
+  driver->dmx.merge_mux = NULL;
 #ifdef DMX_USE_SPINLOCK
   driver->spinlock = (dmx_spinlock_t)DMX_SPINLOCK_INIT;
 #endif
@@ -126,18 +137,39 @@ bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
     dmx_driver_delete(dmx_num);
     DMX_CHECK(driver->mux != NULL, false, "DMX driver mutex malloc error");
   }
+  driver->dmx.staged.mux = xSemaphoreCreateMutex();
+  if (driver->dmx.staged.mux == NULL) {
+    dmx_driver_delete(dmx_num);
+    DMX_CHECK(driver->dmx.staged.mux != NULL, false,
+              "DMX staged buffer mutex malloc error");
+  }
+  driver->dmx.fade_mux = xSemaphoreCreateMutex();
+  if (driver->dmx.fade_mux == NULL) {
+    dmx_driver_delete(dmx_num);
+    DMX_CHECK(driver->dmx.fade_mux != NULL, false,
+              "DMX fade mutex malloc error");
+  }
+  driver->dmx.merge_mux = xSemaphoreCreateMutex();
+  if (driver->dmx.merge_mux == NULL) {
+    dmx_driver_delete(dmx_num);
+    DMX_CHECK(driver->dmx.merge_mux != NULL, false,
+              "DMX merge mutex malloc error");
+  }
 
   // Driver configuration
   driver->dmx_num = dmx_num;
   driver->uid.man_id = RDM_UID_MANUFACTURER_ID;
-#if RDM_UID_DEVICE_ID == 0xffffffff
+#if RDM_UID_DEVICE_ID == 0xffffffff && defined(CONFIG_IDF_TARGET_LINUX)
+  // The host has no MAC address so a fixed device ID is used
+  driver->uid.dev_id = 0x00000000;
+#elif RDM_UID_DEVICE_ID == 0xffffffff
   // Set the device ID based on the device's MAC address
   uint8_t mac[8];
   esp_efuse_mac_get_default(mac);
   driver->uid.dev_id = bswap32(*(uint32_t *)(mac + 2));
 #else
   // Set the device ID based on what the user set in the kconfig
-  driver->uid.dev_id = RDM_UID_DEVICE_UID;
+  driver->uid.dev_id = RDM_UID_DEVICE_ID;
 #endif
   *(uint8_t *)(&driver->uid.dev_id) += dmx_num;  // Increment last octect
   driver->break_len = RDM_BREAK_LEN_US;
@@ -160,15 +192,59 @@ bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
 
   // Synchronization state
   driver->task_waiting = NULL;
+  for (int i = 0; i < DMX_SUBSCRIBER_MAX; ++i) {
+    driver->subscribers[i].semaphore = NULL;
+    driver->subscribers[i].is_closed = false;
+    driver->subscribers[i].users = 0;
+  }
 
   // Data buffer
   driver->dmx.head = DMX_HEAD_WAITING_FOR_BREAK;
   driver->dmx.size = DMX_PACKET_SIZE_MAX;
-  memset(driver->dmx.data, 0, sizeof(driver->dmx.data));
+  memset(driver->dmx.buffers, 0, sizeof(driver->dmx.buffers));
+  driver->dmx.data = driver->dmx.buffers[0];
+  driver->dmx.staged.data = driver->dmx.buffers[1];
+  driver->dmx.staged.is_locked = false;
+  driver->dmx.staged.is_pending = false;
+  driver->dmx.staged.is_stale = false;
+  driver->dmx.staged.dirty_start = 0;
+  driver->dmx.staged.dirty_end = 0;
+  driver->dmx.staged.size = 0;
+  driver->dmx.frame.data = NULL;
+  driver->dmx.frame.size = 0;
+  driver->dmx.frame.sequence = 0;
+  driver->dmx.sequence = 0;
+  driver->dmx.frame.break_timestamp = -1;
+  driver->dmx.frame.eop_timestamp = -1;
+  driver->dmx.frame.leases = 0;
+  memset(driver->dmx.last_frame, 0, sizeof(driver->dmx.last_frame));
+  memset(driver->dmx.changed_slots, 0xff, sizeof(driver->dmx.changed_slots));
+  driver->dmx.changed_slots[DMX_SLOT_BITMAP_LEN - 1] =
+      ((uint32_t)1 << (DMX_PACKET_SIZE_MAX % 32)) - 1;  // Only real slots
+  driver->dmx.continuous.is_enabled = false;
+  driver->dmx.auto_size.is_enabled = false;
+  driver->dmx.auto_size.break_to_break = DMX_BREAK_TO_BREAK_MIN_US;
+  driver->dmx.send_cb.callback = NULL;
+  driver->dmx.send_cb.context = NULL;
+  driver->dmx.fade = NULL;
+  driver->dmx.merge = NULL;
+  driver->dmx.router = NULL;
+  driver->dmx.patch.is_enabled = false;
+  driver->dmx.patch.table = NULL;
+  driver->dmx.window.size = 0;
+  driver->dmx.window.is_notified = false;
+  driver->dmx.generation = 1;
+  driver->dmx.checksum = 0;
+  driver->dmx.checksum_len = 0;
   driver->dmx.status = DMX_STATUS_IDLE;
   driver->dmx.progress = DMX_PROGRESS_STALE;
   driver->dmx.last_controller_pid = 0;
+  driver->dmx.break_timestamp = -(int64_t)UINT32_MAX;  // Never limits spacing
   driver->dmx.controller_eop_timestamp = 0;
+  driver->dmx.rx_break_timestamp = -1;
+  driver->dmx.rx_eop_timestamp = -1;
+  driver->dmx.last_rx_break_timestamp = -1;
+  driver->dmx.last_rx_eop_timestamp = -1;
   driver->dmx.last_responder_pid = 0;
   driver->dmx.responder_sent_last = false;
   driver->dmx.last_request_pid = 0;
@@ -176,6 +252,17 @@ bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
 
   // RDM responder configuration
   driver->rdm.tn = 0;
+  for (int i = 0; i < RDM_FORMAT_CACHE_SIZE; ++i) {
+    driver->rdm.formats[i].string = NULL;
+  }
+  driver->rdm.header_cache.generation = 0;  // Force decoding the first header
+  driver->rdm.dmx_data = NULL;
+
+  // Receive statistics
+  driver->stats.seq = 0;
+  driver->stats.last_packet_timestamp = -1;
+  driver->stats.is_rdm_invalid = false;
+  memset(&driver->stats.values, 0, sizeof(driver->stats.values));
 
   // DMX sniffer configuration
   driver->sniffer.is_enabled = false;
@@ -223,10 +310,13 @@ bool dmx_driver_install(dmx_port_t dmx_num, const dmx_config_t *config,
   rdm_register_parameter_description(dmx_num, NULL, NULL);
 
   // Initialize the UART peripheral
+  dmx_hal_set(dmx_num, hal);
   if (!dmx_uart_init(dmx_num, driver, interrupt_flags)) {
     dmx_driver_delete(dmx_num);
     DMX_CHECK(false, false, "UART init error");
   }
+  driver->rx_timeout_len =
+      dmx_get_rx_timeout_len(dmx_uart_get_baud_rate(dmx_num));
 
   // Initialize the timer peripheral
   if (!dmx_timer_init(dmx_num, driver, interrupt_flags)) {
@@ -258,6 +348,11 @@ bool dmx_driver_delete(dmx_port_t dmx_num) {
   }
   SemaphoreHandle_t mux = driver->mux;
 
+  // Stop sending DMX continuously
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.continuous.is_enabled = false;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
   // Uninstall sniffer ISR
   if (dmx_sniffer_is_enabled(dmx_num)) {
     dmx_sniffer_disable(dmx_num);
@@ -294,6 +389,35 @@ bool dmx_driver_delete(dmx_port_t dmx_num) {
     device = next_device;
   } 
 
+  // Delete the semaphores of the frame subscribers
+  for (int i = 0; i < DMX_SUBSCRIBER_MAX; ++i) {
+    if (driver->subscribers[i].semaphore != NULL) {
+      vSemaphoreDelete(driver->subscribers[i].semaphore);
+    }
+  }
+
+  // Delete the mutexes of the staged buffer and the fade and merge engines
+  if (driver->dmx.staged.mux != NULL) {
+    vSemaphoreDelete(driver->dmx.staged.mux);
+  }
+  if (driver->dmx.fade_mux != NULL) {
+    vSemaphoreDelete(driver->dmx.fade_mux);
+  }
+  if (driver->dmx.merge_mux != NULL) {
+    vSemaphoreDelete(driver->dmx.merge_mux);
+  }
+
+  // Free the fade and merge engines, the patch table, and the router
+  heap_caps_free(driver->dmx.fade);
+  heap_caps_free(driver->dmx.merge);
+  heap_caps_free(driver->dmx.patch.table);
+  if (driver->dmx.router != NULL) {
+    for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+      vSemaphoreDelete(driver->dmx.router->routes[i].semaphore);
+    }
+    heap_caps_free(driver->dmx.router);
+  }
+
   // Free driver
   heap_caps_free(driver);
   dmx_driver[dmx_num] = NULL;
@@ -399,6 +523,7 @@ uint32_t dmx_set_baud_rate(dmx_port_t dmx_num, uint32_t baud_rate) {
 
   taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
   dmx_uart_set_baud_rate(dmx_num, baud_rate);
+  dmx_driver[dmx_num]->rx_timeout_len = dmx_get_rx_timeout_len(baud_rate);
   taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
 
   return baud_rate;
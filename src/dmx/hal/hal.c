@@ -0,0 +1,22 @@
+#include "dmx/hal/include/hal.h"
+
+#include "dmx/include/service.h"
+
+const dmx_uart_hal_t *dmx_uart_hal[DMX_NUM_MAX] = {
+    [0 ... DMX_NUM_MAX - 1] = &dmx_uart_hal_default};
+const dmx_timer_hal_t *dmx_timer_hal[DMX_NUM_MAX] = {
+    [0 ... DMX_NUM_MAX - 1] = &dmx_timer_hal_default};
+const dmx_gpio_hal_t *dmx_gpio_hal[DMX_NUM_MAX] = {
+    [0 ... DMX_NUM_MAX - 1] = &dmx_gpio_hal_default};
+
+const dmx_hal_t dmx_hal_default = {
+    .uart = &dmx_uart_hal_default,
+    .timer = &dmx_timer_hal_default,
+    .gpio = &dmx_gpio_hal_default,
+};
+
+void dmx_hal_set(dmx_port_t dmx_num, const dmx_hal_t *hal) {
+  dmx_uart_hal[dmx_num] = hal->uart;
+  dmx_timer_hal[dmx_num] = hal->timer;
+  dmx_gpio_hal[dmx_num] = hal->gpio;
+}
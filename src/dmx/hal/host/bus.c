@@ -0,0 +1,930 @@
+#include "sdkconfig.h"
+
+// Only built for the ESP-IDF linux target. Arduino compiles every source file.
+#ifdef CONFIG_IDF_TARGET_LINUX
+
+#include "include/bus.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dmx/hal/include/timer.h"
+#include "dmx/include/service.h"
+#include "dmx/sim.h"
+#include "freertos/task.h"
+#include "rdm/include/driver.h"
+#include "rdm/include/uid.h"
+#include "rdm/responder/include/discovery.h"
+
+#define DMX_BUS_TIME_NONE (INT64_MAX)
+
+enum {
+  DMX_BUS_BITS_PER_SLOT = 11,  // Start bit, 8 data bits, and 2 stop bits.
+  DMX_BUS_TASK_STACK_SIZE = 4096,
+  DMX_BUS_DISPATCH_MAX = 16,  // Maximum ISR dispatch rounds per bus event.
+  DMX_BUS_RDM_PACKET_SIZE_MAX = 257,  // Maximum RDM packet size with checksum.
+};
+
+typedef struct dmx_bus_fifo_t {
+  uint8_t data[DMX_BUS_FIFO_SIZE];  // The FIFO buffer.
+  int head;  // The index of the oldest byte in the FIFO.
+  int len;   // The number of bytes in the FIFO.
+} dmx_bus_fifo_t;
+
+typedef struct dmx_bus_port_t {
+  struct dmx_bus_uart_t {
+    void (*isr)(void *);  // The UART ISR, or NULL if the UART is detached.
+    void *isr_context;    // Context for the UART ISR.
+    uint32_t baud_rate;   // The baud rate of the UART.
+    int rts;              // 1 if the port is reading, 0 if it is writing.
+    int tx_invert;        // 1 if the TX line is inverted.
+    int64_t driver_enable_time;  // Time at which the RS-485 driver is active.
+    uint32_t intr_raw;    // The raw interrupt flags which must be cleared.
+    uint32_t intr_ena;    // The enabled interrupt flags.
+    int rxfifo_full_threshold;
+    int txfifo_empty_threshold;
+    int rx_timeout;          // RX idle time in slots before a timeout, or 0.
+    int64_t rx_tout_time;    // Time at which the RX timeout expires, if any.
+    dmx_bus_fifo_t rxfifo;
+    dmx_bus_fifo_t txfifo;
+    int64_t tx_shift_end;  // End of the slot being shifted out, if any.
+    bool break_is_detected;  // True if the current break has been detected.
+  } uart;
+  struct dmx_bus_timer_t {
+    bool (*isr)(void *);  // The timer ISR, or NULL if the timer is detached.
+    void *isr_context;    // Context for the timer ISR.
+    bool is_running;      // True if the timer is counting.
+    uint64_t count;       // The counter value at count_time.
+    int64_t count_time;   // The time at which the counter was last latched.
+    uint64_t alarm;       // The alarm value of the timer.
+    bool alarm_is_enabled;
+    bool auto_reload;
+    bool is_pending;  // True if the timer ISR must be called.
+  } timer;
+  struct dmx_bus_gpio_t {
+    void (*isr)(void *);  // The GPIO ISR, or NULL if the GPIO is detached.
+    void *isr_context;    // Context for the GPIO ISR.
+    bool is_pending;      // True if the GPIO ISR must be called.
+  } gpio;
+  dmx_sim_stats_t stats;
+} dmx_bus_port_t;
+
+static struct dmx_bus_t {
+  TaskHandle_t task;  // The task which processes bus events.
+  int64_t now;        // The virtual time of the bus in nanoseconds.
+  int64_t turnaround;  // The RS-485 transceiver turnaround time.
+  int level;           // The level of the bus as seen by the GPIO.
+  bool is_low;         // True if a port is holding the bus low.
+  int64_t low_time;    // The time at which the bus was pulled low.
+  struct dmx_bus_slot_t {
+    bool is_active;      // True if a slot is on the bus.
+    int64_t start_time;  // The time of the start bit of the slot.
+    int64_t end_time;    // The time of the end of the last stop bit.
+    uint8_t value;       // The value of the slot.
+    bool is_corrupt;     // True if colliding slots were not bit-aligned.
+    int source_count;    // The number of transmitters driving the slot.
+  } slot;
+  dmx_bus_port_t port[DMX_NUM_MAX];
+  struct dmx_bus_rdm_t {
+    rdm_disc_responder_t *responders;  // The emulated responders by UID.
+    size_t count;                     // The number of emulated responders.
+    size_t capacity;       // The number of responders which fit in the array.
+    int64_t response_time;  // Time from the end of a request to the response.
+    struct dmx_bus_rdm_rx_t {
+      bool is_receiving;  // True if a packet is being received.
+      uint8_t data[DMX_BUS_RDM_PACKET_SIZE_MAX];
+      int len;  // The number of slots that have been received.
+    } rx;
+    struct dmx_bus_rdm_tx_t {
+      int64_t next_time;  // The time of the next transmit event, if any.
+      bool has_break;     // True if the response begins with a break.
+      bool is_breaking;   // True if the responders are holding the bus low.
+      uint8_t data[DMX_BUS_RDM_PACKET_SIZE_MAX];
+      int len;           // The number of slots in the response.
+      int head;          // The index of the next slot to send.
+      int source_count;  // The number of responders sending the response.
+    } tx;
+    dmx_sim_rdm_stats_t stats;
+  } rdm;
+} dmx_bus = {
+    .rdm = {.response_time = (int64_t)RDM_TIMING_RESPONDER_MIN * 1000,
+            .tx.next_time = DMX_BUS_TIME_NONE}};
+
+static int64_t dmx_bus_get_slot_time(uint32_t baud_rate) {
+  return (int64_t)DMX_BUS_BITS_PER_SLOT * 1000000000 / baud_rate;
+}
+
+static int64_t dmx_bus_get_bit_time(uint32_t baud_rate) {
+  return (int64_t)1000000000 / baud_rate;
+}
+
+static bool dmx_bus_is_driving(const dmx_bus_port_t *port) {
+  return port->uart.isr != NULL && port->uart.rts == 0 &&
+         port->uart.driver_enable_time <= dmx_bus.now;
+}
+
+static bool dmx_bus_is_reading(const dmx_bus_port_t *port) {
+  return port->uart.isr != NULL && port->uart.rts == 1;
+}
+
+static void dmx_bus_notify(void) {
+  // The bus task is notified when it may have new events to process
+  if (dmx_bus.task != NULL && xTaskGetCurrentTaskHandle() != dmx_bus.task) {
+    xTaskNotifyGive(dmx_bus.task);
+  }
+}
+
+static void dmx_bus_update_level(void) {
+  const int level = !(dmx_bus.is_low || dmx_bus.slot.is_active);
+  if (level != dmx_bus.level) {
+    dmx_bus.level = level;
+    for (int i = 0; i < DMX_NUM_MAX; ++i) {
+      if (dmx_bus.port[i].gpio.isr != NULL) {
+        dmx_bus.port[i].gpio.is_pending = true;
+      }
+    }
+  }
+}
+
+static void dmx_bus_update_line(void) {
+  bool is_low = dmx_bus.rdm.tx.is_breaking;
+  for (int i = 0; i < DMX_NUM_MAX; ++i) {
+    const dmx_bus_port_t *port = &dmx_bus.port[i];
+    if (port->uart.tx_invert && dmx_bus_is_driving(port)) {
+      is_low = true;
+      break;
+    }
+  }
+
+  if (is_low && !dmx_bus.is_low) {
+    // A new break has started
+    dmx_bus.low_time = dmx_bus.now;
+    for (int i = 0; i < DMX_NUM_MAX; ++i) {
+      dmx_bus.port[i].uart.break_is_detected = false;
+    }
+    dmx_bus.rdm.rx.is_receiving = false;
+  } else if (!is_low && dmx_bus.is_low) {
+    // The emulated responders begin receiving a packet after a valid break
+    const int64_t slot_time = dmx_bus_get_slot_time(DMX_BAUD_RATE);
+    if (dmx_bus.now - dmx_bus.low_time >= slot_time) {
+      dmx_bus.rdm.rx.is_receiving = true;
+      dmx_bus.rdm.rx.len = 0;
+    }
+
+    // A low pulse that was too short to be a break is a malformed slot
+    for (int i = 0; i < DMX_NUM_MAX; ++i) {
+      dmx_bus_port_t *port = &dmx_bus.port[i];
+      if (dmx_bus_is_reading(port) && !port->uart.break_is_detected) {
+        port->uart.intr_raw |= UART_INTR_FRAM_ERR;
+        ++port->stats.framing_errors;
+      }
+    }
+  }
+  dmx_bus.is_low = is_low;
+
+  dmx_bus_update_level();
+}
+
+static void dmx_bus_put_slot(uint8_t value, uint32_t baud_rate,
+                             int source_count) {
+  const int64_t end_time = dmx_bus.now + dmx_bus_get_slot_time(baud_rate);
+  struct dmx_bus_slot_t *slot = &dmx_bus.slot;
+  if (!slot->is_active) {
+    slot->is_active = true;
+    slot->start_time = dmx_bus.now;
+    slot->end_time = end_time;
+    slot->value = value;
+    slot->is_corrupt = false;
+    slot->source_count = source_count;
+  } else {
+    // Colliding slots are merged; a low bit on the bus overrides a high bit
+    if (dmx_bus.now - slot->start_time >= dmx_bus_get_bit_time(baud_rate)) {
+      slot->is_corrupt = true;  // The start bits are not aligned
+    }
+    slot->value &= value;
+    if (end_time > slot->end_time) {
+      slot->end_time = end_time;
+    }
+    slot->source_count += source_count;
+  }
+  dmx_bus_update_level();
+}
+
+static size_t dmx_bus_rdm_find(const rdm_uid_t *uid) {
+  // Binary search for the first responder with a UID not less than uid
+  size_t low = 0, high = dmx_bus.rdm.count;
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    if (rdm_uid_is_lt(&dmx_bus.rdm.responders[mid].uid, uid)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+static void dmx_bus_rdm_handle_request(void) {
+  struct dmx_bus_rdm_t *rdm = &dmx_bus.rdm;
+  const uint8_t *request = rdm->rx.data;
+
+  // Verify the checksum and ignore responses sent by other devices
+  rdm_header_t header;
+  if (!rdm_packet_read_header(request, &header) ||
+      !rdm_cc_is_request(header.cc) || header.message_len != 24 + header.pdl) {
+    return;
+  }
+  ++rdm->stats.requests;
+
+  // Get the range of UIDs that are targeted by the request
+  const bool is_disc = (header.cc == RDM_CC_DISC_COMMAND &&
+                        (header.pid == RDM_PID_DISC_UNIQUE_BRANCH ||
+                         header.pid == RDM_PID_DISC_MUTE ||
+                         header.pid == RDM_PID_DISC_UN_MUTE));
+  rdm_disc_unique_branch_t branch;
+  if (is_disc && header.pid == RDM_PID_DISC_UNIQUE_BRANCH) {
+    ++rdm->stats.disc_unique_branch;
+    if (header.pdl != sizeof(branch) ||
+        !rdm_packet_read_pd(request, "uu$", &branch, sizeof(branch))) {
+      return;
+    }
+  } else if (rdm_uid_is_broadcast(&header.dest_uid)) {
+    branch.lower_bound.man_id =
+        header.dest_uid.man_id == 0xffff ? 0 : header.dest_uid.man_id;
+    branch.lower_bound.dev_id = 0;
+    branch.upper_bound.man_id = header.dest_uid.man_id;
+    branch.upper_bound.dev_id = RDM_UID_MAX.dev_id;
+  } else {
+    branch.lower_bound = header.dest_uid;
+    branch.upper_bound = header.dest_uid;
+  }
+
+  /* Every targeted responder handles the request with the same discovery
+  handler as the DMX driver and all of them respond simultaneously. Colliding
+  responses are merged; a low bit overrides a high bit.*/
+  uint8_t *response = rdm->tx.data;
+  int source_count = 0;
+  for (size_t i = dmx_bus_rdm_find(&branch.lower_bound); i < rdm->count; ++i) {
+    rdm_disc_responder_t *responder = &rdm->responders[i];
+    if (rdm_uid_is_gt(&responder->uid, &branch.upper_bound)) {
+      break;
+    }
+
+    uint8_t data[DMX_BUS_RDM_PACKET_SIZE_MAX];
+    int len;
+    if (is_disc) {
+      rdm_header_t response_header;
+      if (!rdm_disc_handle_request(responder, &header, &branch,
+                                   &response_header)) {
+        continue;
+      }
+      len = rdm_packet_write(data, &response_header, RDM_DISC_MUTE_FORMAT,
+                             &responder->mute);
+    } else {
+      // Emulated responders only support RDM discovery
+      const rdm_header_t response_header = {
+          .message_len = 24 + sizeof(uint16_t),
+          .dest_uid = header.src_uid,
+          .src_uid = responder->uid,
+          .tn = header.tn,
+          .response_type = RDM_RESPONSE_TYPE_NACK_REASON,
+          .message_count = 0,
+          .sub_device = header.sub_device,
+          .cc = (header.cc | 0x1),  // Set to RDM_CC_x_COMMAND_RESPONSE
+          .pid = header.pid,
+          .pdl = sizeof(uint16_t)};
+      const uint16_t nack_reason = RDM_NR_UNKNOWN_PID;
+      len = rdm_packet_write(data, &response_header, "w", &nack_reason);
+    }
+    for (int j = 0; j < len; ++j) {
+      response[j] = source_count > 0 ? response[j] & data[j] : data[j];
+    }
+    rdm->tx.len = len;
+    ++source_count;
+  }
+  if (header.cc == RDM_CC_DISC_COMMAND && header.pid == RDM_PID_DISC_MUTE) {
+    ++rdm->stats.disc_mute;
+  } else if (header.cc == RDM_CC_DISC_COMMAND &&
+             header.pid == RDM_PID_DISC_UN_MUTE) {
+    ++rdm->stats.disc_un_mute;
+  }
+
+  // Responders must not respond to requests sent to a broadcast address
+  if (source_count == 0 || (rdm_uid_is_broadcast(&header.dest_uid) &&
+                            header.pid != RDM_PID_DISC_UNIQUE_BRANCH)) {
+    return;
+  }
+  ++rdm->stats.responses;
+  if (source_count > 1) {
+    ++rdm->stats.collisions;
+  }
+  rdm->tx.has_break = (header.pid != RDM_PID_DISC_UNIQUE_BRANCH);
+  rdm->tx.head = 0;
+  rdm->tx.source_count = source_count;
+  rdm->tx.next_time = dmx_bus.now + rdm->response_time;
+}
+
+static void dmx_bus_rdm_receive(uint8_t value, bool is_corrupt) {
+  struct dmx_bus_rdm_rx_t *rx = &dmx_bus.rdm.rx;
+  if (!rx->is_receiving) {
+    return;
+  } else if (is_corrupt || dmx_bus.rdm.tx.next_time != DMX_BUS_TIME_NONE) {
+    rx->is_receiving = false;  // Can't handle this packet
+    return;
+  }
+
+  rx->data[rx->len] = value;
+  ++rx->len;
+  if ((rx->len == 1 && value != RDM_SC) ||
+      (rx->len == 2 && value != RDM_SUB_SC) || (rx->len == 3 && value < 24)) {
+    rx->is_receiving = false;  // Not an RDM packet
+  } else if (rx->len >= 3 && rx->len == rx->data[2] + 2) {
+    rx->is_receiving = false;
+    dmx_bus_rdm_handle_request();
+  }
+}
+
+static void dmx_bus_rdm_transmit(void) {
+  struct dmx_bus_rdm_tx_t *tx = &dmx_bus.rdm.tx;
+  if (tx->next_time > dmx_bus.now) {
+    return;
+  }
+
+  if (tx->has_break && !tx->is_breaking) {
+    // Begin the RDM break
+    tx->is_breaking = true;
+    dmx_bus_update_line();
+    tx->next_time = dmx_bus.now + (int64_t)RDM_BREAK_LEN_US * 1000;
+  } else if (tx->has_break) {
+    // Begin the RDM mark-after-break
+    tx->has_break = false;
+    tx->is_breaking = false;
+    dmx_bus_update_line();
+    tx->next_time = dmx_bus.now + (int64_t)RDM_MAB_LEN_US * 1000;
+  } else if (tx->head < tx->len) {
+    dmx_bus_put_slot(tx->data[tx->head], DMX_BAUD_RATE, tx->source_count);
+    ++tx->head;
+    tx->next_time = dmx_bus.now + dmx_bus_get_slot_time(DMX_BAUD_RATE);
+  } else {
+    tx->next_time = DMX_BUS_TIME_NONE;
+  }
+}
+
+static void dmx_bus_end_slot(void) {
+  struct dmx_bus_slot_t *slot = &dmx_bus.slot;
+  for (int i = 0; i < DMX_NUM_MAX; ++i) {
+    dmx_bus_port_t *port = &dmx_bus.port[i];
+    if (!dmx_bus_is_reading(port)) {
+      continue;
+    }
+
+    dmx_bus_fifo_t *fifo = &port->uart.rxfifo;
+    if (fifo->len == DMX_BUS_FIFO_SIZE) {
+      port->uart.intr_raw |= UART_INTR_RXFIFO_OVF;
+      ++port->stats.rx_overflows;
+    } else {
+      fifo->data[(fifo->head + fifo->len) % DMX_BUS_FIFO_SIZE] = slot->value;
+      ++fifo->len;
+      ++port->stats.slots_received;
+    }
+    if (port->uart.rx_timeout > 0) {
+      port->uart.rx_tout_time =
+          dmx_bus.now +
+          port->uart.rx_timeout * dmx_bus_get_slot_time(port->uart.baud_rate);
+    }
+    if (slot->is_corrupt) {
+      port->uart.intr_raw |= UART_INTR_FRAM_ERR;
+      ++port->stats.framing_errors;
+    }
+    if (slot->source_count > 1) {
+      ++port->stats.collisions;
+    }
+  }
+  slot->is_active = false;
+  dmx_bus_rdm_receive(slot->value, slot->is_corrupt);
+  dmx_bus_update_level();
+}
+
+static void dmx_bus_shift_slot(dmx_bus_port_t *port) {
+  dmx_bus_fifo_t *fifo = &port->uart.txfifo;
+  const uint8_t value = fifo->data[fifo->head];
+  fifo->head = (fifo->head + 1) % DMX_BUS_FIFO_SIZE;
+  --fifo->len;
+
+  port->uart.tx_shift_end =
+      dmx_bus.now + dmx_bus_get_slot_time(port->uart.baud_rate);
+
+  // The slot only reaches the bus if the port is driving a marking line
+  if (dmx_bus_is_driving(port) && !port->uart.tx_invert) {
+    dmx_bus_put_slot(value, port->uart.baud_rate, 1);
+  }
+}
+
+static uint64_t dmx_bus_timer_get_count(const dmx_bus_port_t *port) {
+  uint64_t count = port->timer.count;
+  if (port->timer.is_running) {
+    count += (dmx_bus.now - port->timer.count_time) / 1000;
+  }
+  return count;
+}
+
+static int64_t dmx_bus_timer_get_alarm_time(const dmx_bus_port_t *port) {
+  if (port->timer.isr == NULL || !port->timer.is_running ||
+      !port->timer.alarm_is_enabled) {
+    return DMX_BUS_TIME_NONE;
+  } else if (port->timer.count >= port->timer.alarm) {
+    return dmx_bus.now;
+  }
+  return port->timer.count_time +
+         (int64_t)(port->timer.alarm - port->timer.count) * 1000;
+}
+
+static uint32_t dmx_bus_get_intr_raw(const dmx_bus_port_t *port) {
+  uint32_t intr_raw = port->uart.intr_raw;
+  if (port->uart.rxfifo.len >= port->uart.rxfifo_full_threshold) {
+    intr_raw |= UART_INTR_RXFIFO_FULL;
+  }
+  if (port->uart.txfifo.len < port->uart.txfifo_empty_threshold) {
+    intr_raw |= UART_INTR_TXFIFO_EMPTY;
+  }
+  return intr_raw;
+}
+
+static int64_t dmx_bus_get_next_event_time(void) {
+  int64_t next = DMX_BUS_TIME_NONE;
+  if (dmx_bus.slot.is_active && dmx_bus.slot.end_time < next) {
+    next = dmx_bus.slot.end_time;
+  }
+  if (dmx_bus.rdm.tx.next_time < next) {
+    next = dmx_bus.rdm.tx.next_time;
+  }
+  for (int i = 0; i < DMX_NUM_MAX; ++i) {
+    const dmx_bus_port_t *port = &dmx_bus.port[i];
+    if (port->uart.tx_shift_end < next) {
+      next = port->uart.tx_shift_end;
+    }
+    if (port->uart.rxfifo.len > 0 && port->uart.rx_tout_time < next) {
+      next = port->uart.rx_tout_time;
+    }
+    if (port->uart.rts == 0 && port->uart.driver_enable_time > dmx_bus.now &&
+        port->uart.driver_enable_time < next) {
+      next = port->uart.driver_enable_time;
+    }
+    if (dmx_bus.is_low && dmx_bus_is_reading(port) &&
+        !port->uart.break_is_detected) {
+      const int64_t break_time =
+          dmx_bus.low_time + dmx_bus_get_slot_time(port->uart.baud_rate);
+      if (break_time < next) {
+        next = break_time;
+      }
+    }
+    const int64_t alarm_time = dmx_bus_timer_get_alarm_time(port);
+    if (alarm_time < next) {
+      next = alarm_time;
+    }
+  }
+  return next < dmx_bus.now ? dmx_bus.now : next;
+}
+
+static void dmx_bus_advance(int64_t time) {
+  dmx_bus.now = time;
+
+  // RS-485 drivers which have finished turning around may pull the bus low
+  dmx_bus_update_line();
+
+  // Deliver the slot on the bus before new slots are started
+  if (dmx_bus.slot.is_active && dmx_bus.slot.end_time <= dmx_bus.now) {
+    dmx_bus_end_slot();
+  }
+
+  // The emulated RDM responders send their response
+  dmx_bus_rdm_transmit();
+
+  for (int i = 0; i < DMX_NUM_MAX; ++i) {
+    dmx_bus_port_t *port = &dmx_bus.port[i];
+
+    // Shift out the next slot or signal that transmission is done
+    if (port->uart.tx_shift_end <= dmx_bus.now) {
+      port->uart.tx_shift_end = DMX_BUS_TIME_NONE;
+      ++port->stats.slots_sent;
+      if (port->uart.txfifo.len > 0) {
+        dmx_bus_shift_slot(port);
+      } else {
+        port->uart.intr_raw |= UART_INTR_TX_DONE;
+      }
+    }
+
+    // The RX timeout flushes slots which are below the RX FIFO full threshold
+    if (port->uart.rx_tout_time <= dmx_bus.now) {
+      port->uart.rx_tout_time = DMX_BUS_TIME_NONE;
+      if (port->uart.rxfifo.len > 0) {
+        port->uart.intr_raw |= UART_INTR_RXFIFO_TOUT;
+      }
+    }
+
+    // A low bus is a break once it has been low for longer than one slot
+    if (dmx_bus.is_low && dmx_bus_is_reading(port) &&
+        !port->uart.break_is_detected &&
+        dmx_bus.low_time + dmx_bus_get_slot_time(port->uart.baud_rate) <=
+            dmx_bus.now) {
+      port->uart.break_is_detected = true;
+      port->uart.intr_raw |= UART_INTR_BRK_DET;
+      ++port->stats.breaks_received;
+    }
+
+    // Latch timer alarms
+    if (dmx_bus_timer_get_alarm_time(port) <= dmx_bus.now) {
+      if (port->timer.auto_reload) {
+        port->timer.count = 0;
+        port->timer.count_time = dmx_bus.now;
+      } else {
+        port->timer.count = dmx_bus_timer_get_count(port);
+        port->timer.count_time = dmx_bus.now;
+        port->timer.alarm_is_enabled = false;
+      }
+      port->timer.is_pending = true;
+    }
+  }
+}
+
+static void dmx_bus_dispatch(void) {
+  for (int round = 0; round < DMX_BUS_DISPATCH_MAX; ++round) {
+    bool isr_was_called = false;
+    for (int i = 0; i < DMX_NUM_MAX; ++i) {
+      dmx_bus_port_t *port = &dmx_bus.port[i];
+      if (port->gpio.is_pending) {
+        port->gpio.is_pending = false;
+        if (port->gpio.isr != NULL) {
+          ++port->stats.gpio_isr_count;
+          port->gpio.isr(port->gpio.isr_context);
+          isr_was_called = true;
+        }
+      }
+      if (port->timer.is_pending) {
+        port->timer.is_pending = false;
+        if (port->timer.isr != NULL) {
+          ++port->stats.timer_isr_count;
+          port->timer.isr(port->timer.isr_context);
+          isr_was_called = true;
+        }
+      }
+      if (port->uart.isr != NULL && dmx_bus_get_interrupt_status(i)) {
+        ++port->stats.uart_isr_count;
+        port->uart.isr(port->uart.isr_context);
+        isr_was_called = true;
+      }
+    }
+    if (!isr_was_called) {
+      break;
+    }
+  }
+}
+
+static void dmx_bus_task(void *arg) {
+  while (true) {
+    // ISRs are not preemptible so the scheduler is suspended while they run
+    vTaskSuspendAll();
+    dmx_bus_dispatch();
+    const int64_t next = dmx_bus_get_next_event_time();
+    if (next != DMX_BUS_TIME_NONE) {
+      dmx_bus_advance(next);
+      dmx_bus_dispatch();
+    }
+    xTaskResumeAll();
+
+    if (next == DMX_BUS_TIME_NONE) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // Wait for bus activity
+    } else {
+      taskYIELD();
+    }
+  }
+}
+
+static void dmx_bus_start(void) {
+  if (dmx_bus.task != NULL) {
+    return;
+  }
+
+  dmx_bus.level = 1;
+  for (int i = 0; i < DMX_NUM_MAX; ++i) {
+    dmx_bus_port_t *port = &dmx_bus.port[i];
+    port->uart.baud_rate = DMX_BAUD_RATE;
+    port->uart.tx_shift_end = DMX_BUS_TIME_NONE;
+    port->uart.rx_tout_time = DMX_BUS_TIME_NONE;
+  }
+  xTaskCreate(dmx_bus_task, "dmx_bus", DMX_BUS_TASK_STACK_SIZE, NULL,
+              tskIDLE_PRIORITY, &dmx_bus.task);
+}
+
+void dmx_bus_uart_attach(dmx_port_t dmx_num, void (*isr)(void *),
+                         void *isr_context) {
+  dmx_bus_start();
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->uart.isr_context = isr_context;
+  port->uart.isr = isr;
+  dmx_bus_update_line();
+  dmx_bus_notify();
+}
+
+void dmx_bus_uart_detach(dmx_port_t dmx_num) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->uart.isr = NULL;
+  port->uart.intr_ena = 0;
+  port->uart.intr_raw = 0;
+  port->uart.rxfifo.len = 0;
+  port->uart.txfifo.len = 0;
+  port->uart.tx_shift_end = DMX_BUS_TIME_NONE;
+  port->uart.rx_tout_time = DMX_BUS_TIME_NONE;
+  dmx_bus_update_line();
+}
+
+uint32_t dmx_bus_get_baud_rate(dmx_port_t dmx_num) {
+  return dmx_bus.port[dmx_num].uart.baud_rate;
+}
+
+void dmx_bus_set_baud_rate(dmx_port_t dmx_num, uint32_t baud_rate) {
+  dmx_bus.port[dmx_num].uart.baud_rate = baud_rate;
+}
+
+void dmx_bus_set_rxfifo_full_threshold(dmx_port_t dmx_num, int threshold) {
+  dmx_bus.port[dmx_num].uart.rxfifo_full_threshold = threshold;
+  dmx_bus_notify();
+}
+
+void dmx_bus_set_rx_timeout(dmx_port_t dmx_num, int timeout) {
+  dmx_bus.port[dmx_num].uart.rx_timeout = timeout;
+}
+
+void dmx_bus_set_txfifo_empty_threshold(dmx_port_t dmx_num, int threshold) {
+  dmx_bus.port[dmx_num].uart.txfifo_empty_threshold = threshold;
+  dmx_bus_notify();
+}
+
+void dmx_bus_invert_tx(dmx_port_t dmx_num, int invert) {
+  dmx_bus.port[dmx_num].uart.tx_invert = invert;
+  dmx_bus_update_line();
+  dmx_bus_notify();
+}
+
+int dmx_bus_get_rts(dmx_port_t dmx_num) {
+  return dmx_bus.port[dmx_num].uart.rts;
+}
+
+void dmx_bus_set_rts(dmx_port_t dmx_num, int set) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  if (port->uart.rts != set) {
+    port->uart.rts = set;
+    if (set == 0) {
+      port->uart.driver_enable_time = dmx_bus.now + dmx_bus.turnaround;
+    }
+    dmx_bus_update_line();
+    dmx_bus_notify();
+  }
+}
+
+uint32_t dmx_bus_get_interrupt_status(dmx_port_t dmx_num) {
+  const dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  return dmx_bus_get_intr_raw(port) & port->uart.intr_ena;
+}
+
+void dmx_bus_enable_interrupt(dmx_port_t dmx_num, uint32_t mask) {
+  dmx_bus.port[dmx_num].uart.intr_ena |= mask;
+  dmx_bus_notify();
+}
+
+void dmx_bus_disable_interrupt(dmx_port_t dmx_num, uint32_t mask) {
+  dmx_bus.port[dmx_num].uart.intr_ena &= ~mask;
+}
+
+void dmx_bus_clear_interrupt(dmx_port_t dmx_num, uint32_t mask) {
+  dmx_bus.port[dmx_num].uart.intr_raw &= ~mask;
+}
+
+uint32_t dmx_bus_get_rxfifo_len(dmx_port_t dmx_num) {
+  return dmx_bus.port[dmx_num].uart.rxfifo.len;
+}
+
+void dmx_bus_read_rxfifo(dmx_port_t dmx_num, uint8_t *buf, int *size) {
+  dmx_bus_fifo_t *fifo = &dmx_bus.port[dmx_num].uart.rxfifo;
+  if (*size > fifo->len) {
+    *size = fifo->len;
+  }
+  for (int i = 0; i < *size; ++i) {
+    buf[i] = fifo->data[fifo->head];
+    fifo->head = (fifo->head + 1) % DMX_BUS_FIFO_SIZE;
+  }
+  fifo->len -= *size;
+}
+
+void dmx_bus_rxfifo_reset(dmx_port_t dmx_num) {
+  dmx_bus_fifo_t *fifo = &dmx_bus.port[dmx_num].uart.rxfifo;
+  fifo->head = 0;
+  fifo->len = 0;
+}
+
+uint32_t dmx_bus_get_txfifo_len(dmx_port_t dmx_num) {
+  return DMX_BUS_FIFO_SIZE - dmx_bus.port[dmx_num].uart.txfifo.len;
+}
+
+void dmx_bus_write_txfifo(dmx_port_t dmx_num, const void *buf, int *size) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  dmx_bus_fifo_t *fifo = &port->uart.txfifo;
+  if (*size > DMX_BUS_FIFO_SIZE - fifo->len) {
+    *size = DMX_BUS_FIFO_SIZE - fifo->len;
+  }
+  for (int i = 0; i < *size; ++i) {
+    fifo->data[(fifo->head + fifo->len) % DMX_BUS_FIFO_SIZE] =
+        ((const uint8_t *)buf)[i];
+    ++fifo->len;
+  }
+
+  // Begin shifting out data if the UART transmitter is idle
+  if (port->uart.tx_shift_end == DMX_BUS_TIME_NONE && fifo->len > 0) {
+    dmx_bus_shift_slot(port);
+  }
+  dmx_bus_notify();
+}
+
+void dmx_bus_txfifo_reset(dmx_port_t dmx_num) {
+  dmx_bus_fifo_t *fifo = &dmx_bus.port[dmx_num].uart.txfifo;
+  fifo->head = 0;
+  fifo->len = 0;
+}
+
+void dmx_bus_timer_attach(dmx_port_t dmx_num, bool (*isr)(void *),
+                          void *isr_context) {
+  dmx_bus_start();
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->timer.isr_context = isr_context;
+  port->timer.is_running = false;
+  port->timer.count = 0;
+  port->timer.alarm_is_enabled = false;
+  port->timer.is_pending = false;
+  port->timer.isr = isr;
+}
+
+void dmx_bus_timer_detach(dmx_port_t dmx_num) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->timer.isr = NULL;
+  port->timer.is_running = false;
+  port->timer.is_pending = false;
+}
+
+void dmx_bus_timer_start(dmx_port_t dmx_num) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  if (!port->timer.is_running) {
+    port->timer.count_time = dmx_bus.now;
+    port->timer.is_running = true;
+    dmx_bus_notify();
+  }
+}
+
+void dmx_bus_timer_stop(dmx_port_t dmx_num) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  if (port->timer.is_running) {
+    port->timer.count = dmx_bus_timer_get_count(port);
+    port->timer.is_running = false;
+  }
+}
+
+void dmx_bus_timer_set_counter(dmx_port_t dmx_num, uint64_t counter) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->timer.count = counter;
+  port->timer.count_time = dmx_bus.now;
+  dmx_bus_notify();
+}
+
+void dmx_bus_timer_set_alarm(dmx_port_t dmx_num, uint64_t alarm,
+                             bool auto_reload) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->timer.count = dmx_bus_timer_get_count(port);
+  port->timer.count_time = dmx_bus.now;
+  port->timer.alarm = alarm;
+  port->timer.auto_reload = auto_reload && alarm > 0;
+  port->timer.alarm_is_enabled = true;
+  dmx_bus_notify();
+}
+
+void dmx_bus_gpio_attach(dmx_port_t dmx_num, void (*isr)(void *),
+                         void *isr_context) {
+  dmx_bus_start();
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->gpio.isr_context = isr_context;
+  port->gpio.is_pending = false;
+  port->gpio.isr = isr;
+}
+
+void dmx_bus_gpio_detach(dmx_port_t dmx_num) {
+  dmx_bus_port_t *port = &dmx_bus.port[dmx_num];
+  port->gpio.isr = NULL;
+  port->gpio.is_pending = false;
+}
+
+int dmx_bus_get_level(void) { return dmx_bus.level; }
+
+int64_t dmx_bus_get_micros(void) { return dmx_bus.now / 1000; }
+
+void dmx_sim_set_turnaround(uint32_t turnaround_us) {
+  dmx_bus.turnaround = (int64_t)turnaround_us * 1000;
+}
+
+int64_t dmx_sim_get_time(void) { return dmx_bus_get_micros(); }
+
+bool dmx_sim_get_stats(dmx_port_t dmx_num, dmx_sim_stats_t *stats) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(stats != NULL, false, "stats is null");
+
+  vTaskSuspendAll();
+  *stats = dmx_bus.port[dmx_num].stats;
+  xTaskResumeAll();
+
+  return true;
+}
+
+bool dmx_sim_reset_stats(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+
+  vTaskSuspendAll();
+  memset(&dmx_bus.port[dmx_num].stats, 0, sizeof(dmx_sim_stats_t));
+  xTaskResumeAll();
+
+  return true;
+}
+
+static int dmx_bus_rdm_compare(const void *a, const void *b) {
+  const rdm_uid_t *uid_a = &((const rdm_disc_responder_t *)a)->uid;
+  const rdm_uid_t *uid_b = &((const rdm_disc_responder_t *)b)->uid;
+  return rdm_uid_is_lt(uid_a, uid_b) ? -1 : rdm_uid_is_gt(uid_a, uid_b);
+}
+
+bool dmx_sim_add_responders(const rdm_uid_t *uids, size_t num) {
+  DMX_CHECK(uids != NULL, false, "uids is null");
+  for (size_t i = 0; i < num; ++i) {
+    DMX_CHECK(!rdm_uid_is_broadcast(&uids[i]) && !rdm_uid_is_null(&uids[i]),
+              false, "uids error");
+  }
+
+  bool ret = true;
+  vTaskSuspendAll();
+  struct dmx_bus_rdm_t *rdm = &dmx_bus.rdm;
+  if (rdm->count + num > rdm->capacity) {
+    size_t capacity = rdm->capacity > 0 ? rdm->capacity : 64;
+    while (capacity < rdm->count + num) {
+      capacity *= 2;
+    }
+    rdm_disc_responder_t *responders =
+        realloc(rdm->responders, sizeof(*responders) * capacity);
+    if (responders != NULL) {
+      rdm->responders = responders;
+      rdm->capacity = capacity;
+    } else {
+      ret = false;
+    }
+  }
+  if (ret) {
+    for (size_t i = 0; i < num; ++i) {
+      // Emulated responders have a single port and no sub-devices
+      rdm->responders[rdm->count] = (rdm_disc_responder_t){.uid = uids[i]};
+      ++rdm->count;
+    }
+    qsort(rdm->responders, rdm->count, sizeof(*rdm->responders),
+          dmx_bus_rdm_compare);
+  }
+  xTaskResumeAll();
+  DMX_CHECK(ret, false, "responder malloc error");
+
+  return true;
+}
+
+void dmx_sim_remove_responders(void) {
+  vTaskSuspendAll();
+  free(dmx_bus.rdm.responders);
+  dmx_bus.rdm.responders = NULL;
+  dmx_bus.rdm.count = 0;
+  dmx_bus.rdm.capacity = 0;
+  xTaskResumeAll();
+}
+
+size_t dmx_sim_get_responder_count(void) { return dmx_bus.rdm.count; }
+
+void dmx_sim_set_response_time(uint32_t response_time_us) {
+  dmx_bus.rdm.response_time = (int64_t)response_time_us * 1000;
+}
+
+bool dmx_sim_get_rdm_stats(dmx_sim_rdm_stats_t *stats) {
+  DMX_CHECK(stats != NULL, false, "stats is null");
+
+  vTaskSuspendAll();
+  *stats = dmx_bus.rdm.stats;
+  xTaskResumeAll();
+
+  return true;
+}
+
+void dmx_sim_reset_rdm_stats(void) {
+  vTaskSuspendAll();
+  memset(&dmx_bus.rdm.stats, 0, sizeof(dmx_sim_rdm_stats_t));
+  xTaskResumeAll();
+}
+
+#endif  // CONFIG_IDF_TARGET_LINUX
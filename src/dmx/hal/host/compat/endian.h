@@ -0,0 +1,22 @@
+/**
+ * @file dmx/hal/host/compat/endian.h
+ * @author Mitch Weisbrod (mitch@theweisbrods.com)
+ * @brief This file provides the byte-swapping macros of the newlib endian.h
+ * header on host C libraries which do not define them. This file is not
+ * considered part of the API and should not be included by the user.
+ */
+#pragma once
+
+#if defined(__has_include_next)
+#if __has_include_next(<endian.h>)
+#include_next <endian.h>
+#endif
+#endif
+
+#ifndef bswap16
+#define bswap16(x) __builtin_bswap16(x)
+#endif
+
+#ifndef bswap32
+#define bswap32(x) __builtin_bswap32(x)
+#endif
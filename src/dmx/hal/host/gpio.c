@@ -0,0 +1,29 @@
+#include "sdkconfig.h"
+
+// Only built for the ESP-IDF linux target. Arduino compiles every source file.
+#ifdef CONFIG_IDF_TARGET_LINUX
+
+#include "dmx/hal/include/gpio.h"
+
+#include "dmx/hal/include/isr.h"
+#include "dmx/include/service.h"
+
+static bool dmx_gpio_sim_init(dmx_port_t dmx_num, void *isr_context,
+                              int sniffer_pin) {
+  dmx_bus_gpio_attach(dmx_num, dmx_gpio_isr, isr_context);
+  return true;
+}
+
+static void dmx_gpio_sim_deinit(dmx_port_t dmx_num) {
+  dmx_bus_gpio_detach(dmx_num);
+}
+
+static int dmx_gpio_sim_read(dmx_port_t dmx_num) { return dmx_bus_get_level(); }
+
+const dmx_gpio_hal_t dmx_gpio_hal_default = {
+    .init = dmx_gpio_sim_init,
+    .deinit = dmx_gpio_sim_deinit,
+    .read = dmx_gpio_sim_read,
+};
+
+#endif  // CONFIG_IDF_TARGET_LINUX
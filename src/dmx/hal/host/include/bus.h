@@ -0,0 +1,314 @@
+/**
+ * @file dmx/hal/host/include/bus.h
+ * @author Mitch Weisbrod (mitch@theweisbrods.com)
+ * @brief This file is the virtual RS-485 bus of the host Hardware Abstraction
+ * Layer (HAL) of esp_dmx. It emulates the UART, timer, and GPIO peripherals of
+ * each DMX port as well as the half-duplex line which connects them. This
+ * allows the DMX driver to run unmodified when esp_dmx is built for the ESP-IDF
+ * linux target.
+ *
+ * The bus runs on a virtual clock which only advances when the bus has work to
+ * do. Bus events, such as the end of a slot or a timer alarm, are processed by
+ * a FreeRTOS task at idle priority. Interrupt service routines are called from
+ * this task while the scheduler is suspended so that, as on a single core
+ * microcontroller, the ISRs are never preempted by other tasks. Tasks which use
+ * the DMX driver must therefore have a priority greater than tskIDLE_PRIORITY.
+ * This file is not considered part of the API and should not be included by
+ * the user.
+ *
+ * The bus may also host emulated RDM responders. These are not DMX ports; they
+ * decode RDM requests directly from the bus and respond to RDM discovery so
+ * that controllers can be tested against thousands of responders.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dmx/include/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief UART interrupt flags of the virtual UART. These use the same layout as
+ * the interrupt registers of the ESP32 UART so that the DMX interrupt masks are
+ * the same on every HAL.
+ */
+enum {
+  UART_INTR_RXFIFO_FULL = (1 << 0),
+  UART_INTR_TXFIFO_EMPTY = (1 << 1),
+  UART_INTR_PARITY_ERR = (1 << 2),
+  UART_INTR_FRAM_ERR = (1 << 3),
+  UART_INTR_RXFIFO_OVF = (1 << 4),
+  UART_INTR_BRK_DET = (1 << 7),
+  UART_INTR_RXFIFO_TOUT = (1 << 8),
+  UART_INTR_TX_DONE = (1 << 14),
+};
+
+/** @brief A mask of every interrupt flag of the virtual UART.*/
+#define DMX_BUS_INTR_MASK (0x7ffff)
+
+/** @brief The size in bytes of the RX and TX FIFOs of the virtual UART.*/
+#define DMX_BUS_FIFO_SIZE (128)
+
+/**
+ * @brief Attaches the virtual UART of a DMX port to the DMX bus. The DMX bus is
+ * started the first time that a peripheral is attached to it.
+ *
+ * @param dmx_num The DMX port number.
+ * @param isr The UART interrupt service routine.
+ * @param[inout] isr_context Context to be used in the UART ISR.
+ */
+void dmx_bus_uart_attach(dmx_port_t dmx_num, void (*isr)(void *),
+                         void *isr_context);
+
+/**
+ * @brief Detaches the virtual UART of a DMX port from the DMX bus.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_uart_detach(dmx_port_t dmx_num);
+
+/**
+ * @brief Gets the baud rate of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @return The baud rate of the virtual UART.
+ */
+uint32_t dmx_bus_get_baud_rate(dmx_port_t dmx_num);
+
+/**
+ * @brief Sets the baud rate of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @param baud_rate The baud rate to use.
+ */
+void dmx_bus_set_baud_rate(dmx_port_t dmx_num, uint32_t baud_rate);
+
+/**
+ * @brief Sets the number of bytes in the RX FIFO at which the
+ * UART_INTR_RXFIFO_FULL interrupt is asserted.
+ *
+ * @param dmx_num The DMX port number.
+ * @param threshold The RX FIFO full threshold.
+ */
+void dmx_bus_set_rxfifo_full_threshold(dmx_port_t dmx_num, int threshold);
+
+/**
+ * @brief Sets the RX timeout of the virtual UART. The UART_INTR_RXFIFO_TOUT
+ * interrupt is asserted when the RX FIFO is not empty and no slot has been
+ * received for the length of the RX timeout.
+ *
+ * @param dmx_num The DMX port number.
+ * @param timeout The RX timeout in slot times, or 0 to disable the RX timeout.
+ */
+void dmx_bus_set_rx_timeout(dmx_port_t dmx_num, int timeout);
+
+/**
+ * @brief Sets the number of bytes in the TX FIFO below which the
+ * UART_INTR_TXFIFO_EMPTY interrupt is asserted.
+ *
+ * @param dmx_num The DMX port number.
+ * @param threshold The TX FIFO empty threshold.
+ */
+void dmx_bus_set_txfifo_empty_threshold(dmx_port_t dmx_num, int threshold);
+
+/**
+ * @brief Inverts or un-inverts the TX line of the virtual UART. An inverted TX
+ * line holds the DMX bus low if the port is driving the DMX bus.
+ *
+ * @param dmx_num The DMX port number.
+ * @param invert 1 to invert, 0 to un-invert.
+ */
+void dmx_bus_invert_tx(dmx_port_t dmx_num, int invert);
+
+/**
+ * @brief Gets the level of the RTS line of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @return 1 if the port is reading the DMX bus, 0 if the port is driving it.
+ */
+int dmx_bus_get_rts(dmx_port_t dmx_num);
+
+/**
+ * @brief Sets the level of the RTS line of the virtual UART. The RS-485 driver
+ * of the port becomes active after the turnaround delay of the DMX bus.
+ *
+ * @param dmx_num The DMX port number.
+ * @param set 1 to read the DMX bus, 0 to drive the DMX bus.
+ */
+void dmx_bus_set_rts(dmx_port_t dmx_num, int set);
+
+/**
+ * @brief Gets the masked interrupt status of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @return The interrupt status mask.
+ */
+uint32_t dmx_bus_get_interrupt_status(dmx_port_t dmx_num);
+
+/**
+ * @brief Enables interrupts of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @param mask The interrupt mask to enable.
+ */
+void dmx_bus_enable_interrupt(dmx_port_t dmx_num, uint32_t mask);
+
+/**
+ * @brief Disables interrupts of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @param mask The interrupt mask to disable.
+ */
+void dmx_bus_disable_interrupt(dmx_port_t dmx_num, uint32_t mask);
+
+/**
+ * @brief Clears interrupts of the virtual UART. Interrupts which reflect the
+ * level of a FIFO remain asserted for as long as the FIFO condition is met.
+ *
+ * @param dmx_num The DMX port number.
+ * @param mask The interrupt mask to clear.
+ */
+void dmx_bus_clear_interrupt(dmx_port_t dmx_num, uint32_t mask);
+
+/**
+ * @brief Gets the number of bytes in the RX FIFO of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @return The number of bytes in the RX FIFO.
+ */
+uint32_t dmx_bus_get_rxfifo_len(dmx_port_t dmx_num);
+
+/**
+ * @brief Reads from the RX FIFO of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] buf Destination buffer to be read into.
+ * @param[inout] size The maximum number of bytes to read. Is set to the number
+ * of bytes read.
+ */
+void dmx_bus_read_rxfifo(dmx_port_t dmx_num, uint8_t *buf, int *size);
+
+/**
+ * @brief Resets the RX FIFO of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_rxfifo_reset(dmx_port_t dmx_num);
+
+/**
+ * @brief Gets the free space in the TX FIFO of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ * @return The number of bytes which may be written to the TX FIFO.
+ */
+uint32_t dmx_bus_get_txfifo_len(dmx_port_t dmx_num);
+
+/**
+ * @brief Writes to the TX FIFO of the virtual UART. The virtual UART begins
+ * shifting out data immediately if it is idle.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[in] buf The source buffer from which to write.
+ * @param[inout] size The number of bytes to write. Is set to the number of
+ * bytes written.
+ */
+void dmx_bus_write_txfifo(dmx_port_t dmx_num, const void *buf, int *size);
+
+/**
+ * @brief Resets the TX FIFO of the virtual UART.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_txfifo_reset(dmx_port_t dmx_num);
+
+/**
+ * @brief Attaches the virtual timer of a DMX port to the DMX bus. The virtual
+ * timer counts at a resolution of 1MHz.
+ *
+ * @param dmx_num The DMX port number.
+ * @param isr The timer interrupt service routine.
+ * @param[inout] isr_context Context to be used in the timer ISR.
+ */
+void dmx_bus_timer_attach(dmx_port_t dmx_num, bool (*isr)(void *),
+                          void *isr_context);
+
+/**
+ * @brief Detaches the virtual timer of a DMX port from the DMX bus.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_timer_detach(dmx_port_t dmx_num);
+
+/**
+ * @brief Starts the virtual timer.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_timer_start(dmx_port_t dmx_num);
+
+/**
+ * @brief Stops the virtual timer.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_timer_stop(dmx_port_t dmx_num);
+
+/**
+ * @brief Sets the counter value of the virtual timer.
+ *
+ * @param dmx_num The DMX port number.
+ * @param counter The counter value in microseconds.
+ */
+void dmx_bus_timer_set_counter(dmx_port_t dmx_num, uint64_t counter);
+
+/**
+ * @brief Sets the alarm of the virtual timer. The alarm triggers immediately if
+ * the counter has already reached the alarm value.
+ *
+ * @param dmx_num The DMX port number.
+ * @param alarm The alarm value in microseconds.
+ * @param auto_reload Set to true to reset the counter to zero and keep the
+ * alarm enabled when the alarm is triggered.
+ */
+void dmx_bus_timer_set_alarm(dmx_port_t dmx_num, uint64_t alarm,
+                             bool auto_reload);
+
+/**
+ * @brief Attaches a virtual GPIO of a DMX port to the DMX bus. The ISR is
+ * called on every edge of the DMX bus.
+ *
+ * @param dmx_num The DMX port number.
+ * @param isr The GPIO interrupt service routine.
+ * @param[inout] isr_context Context to be used in the GPIO ISR.
+ */
+void dmx_bus_gpio_attach(dmx_port_t dmx_num, void (*isr)(void *),
+                         void *isr_context);
+
+/**
+ * @brief Detaches the virtual GPIO of a DMX port from the DMX bus.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_bus_gpio_detach(dmx_port_t dmx_num);
+
+/**
+ * @brief Reads the level of the DMX bus.
+ *
+ * @return 1 if the DMX bus is idle or marking, 0 if it is held low.
+ */
+int dmx_bus_get_level(void);
+
+/**
+ * @brief Gets the virtual time of the DMX bus.
+ *
+ * @return The number of microseconds that have elapsed on the DMX bus.
+ */
+int64_t dmx_bus_get_micros(void);
+
+#ifdef __cplusplus
+}
+#endif
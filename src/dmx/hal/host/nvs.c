@@ -0,0 +1,101 @@
+#include "sdkconfig.h"
+
+// Only built for the ESP-IDF linux target. Arduino compiles every source file.
+#ifdef CONFIG_IDF_TARGET_LINUX
+
+#include "dmx/hal/include/nvs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dmx/include/service.h"
+
+/* The host has no flash so non-volatile parameters are kept in memory for the
+ * lifetime of the process.*/
+typedef struct dmx_nvs_entry_t {
+  struct dmx_nvs_entry_t *next;  // A pointer to the next entry.
+  dmx_port_t dmx_num;            // The DMX port number of the parameter.
+  rdm_sub_device_t sub_device;   // The sub-device which owns the parameter.
+  rdm_pid_t pid;                 // The parameter ID.
+  size_t size;                   // The size of the parameter data.
+  uint8_t data[];                // The parameter data.
+} dmx_nvs_entry_t;
+
+static dmx_nvs_entry_t *dmx_nvs_entries = NULL;
+static dmx_spinlock_t dmx_nvs_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static dmx_nvs_entry_t **dmx_nvs_find(dmx_port_t dmx_num,
+                                      rdm_sub_device_t sub_device,
+                                      rdm_pid_t pid) {
+  dmx_nvs_entry_t **entry = &dmx_nvs_entries;
+  while (*entry != NULL &&
+         ((*entry)->dmx_num != dmx_num || (*entry)->sub_device != sub_device ||
+          (*entry)->pid != pid)) {
+    entry = &(*entry)->next;
+  }
+  return entry;
+}
+
+void dmx_nvs_init(dmx_port_t dmx_num) {
+  // Nothing to initialize on the host
+}
+
+size_t dmx_nvs_get(dmx_port_t dmx_num, rdm_sub_device_t sub_device,
+                   rdm_pid_t pid, void *param, size_t size) {
+  assert(dmx_num < DMX_NUM_MAX);
+  assert(pid > 0);
+  assert(sub_device < RDM_SUB_DEVICE_MAX);
+  assert(param != NULL);
+
+  if (size == 0) {
+    return size;
+  }
+
+  taskENTER_CRITICAL(&dmx_nvs_spinlock);
+  const dmx_nvs_entry_t *entry = *dmx_nvs_find(dmx_num, sub_device, pid);
+  if (entry != NULL && entry->size <= size) {
+    memcpy(param, entry->data, entry->size);
+    size = entry->size;
+  } else {
+    size = 0;
+  }
+  taskEXIT_CRITICAL(&dmx_nvs_spinlock);
+
+  return size;
+}
+
+bool dmx_nvs_set(dmx_port_t dmx_num, rdm_sub_device_t sub_device, rdm_pid_t pid,
+                 const void *param, size_t size) {
+  assert(dmx_num < DMX_NUM_MAX);
+  assert(pid > 0);
+  assert(sub_device < 513);
+  assert(param != NULL);
+
+  if (size == 0) {
+    return true;
+  }
+
+  // Allocate the new entry before entering the critical section
+  dmx_nvs_entry_t *new_entry = malloc(sizeof(dmx_nvs_entry_t) + size);
+  if (new_entry == NULL) {
+    return false;
+  }
+  new_entry->dmx_num = dmx_num;
+  new_entry->sub_device = sub_device;
+  new_entry->pid = pid;
+  new_entry->size = size;
+  memcpy(new_entry->data, param, size);
+
+  // Replace the old entry, if it exists
+  taskENTER_CRITICAL(&dmx_nvs_spinlock);
+  dmx_nvs_entry_t **entry = dmx_nvs_find(dmx_num, sub_device, pid);
+  dmx_nvs_entry_t *old_entry = *entry;
+  new_entry->next = old_entry != NULL ? old_entry->next : NULL;
+  *entry = new_entry;
+  taskEXIT_CRITICAL(&dmx_nvs_spinlock);
+  free(old_entry);
+
+  return true;
+}
+
+#endif  // CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,50 @@
+#include "sdkconfig.h"
+
+// Only built for the ESP-IDF linux target. Arduino compiles every source file.
+#ifdef CONFIG_IDF_TARGET_LINUX
+
+#include "dmx/hal/include/timer.h"
+
+#include "dmx/hal/include/isr.h"
+#include "dmx/include/service.h"
+
+static bool dmx_timer_sim_init(dmx_port_t dmx_num, void *isr_context,
+                               int isr_flags) {
+  dmx_bus_timer_attach(dmx_num, dmx_timer_isr, isr_context);
+  return true;
+}
+
+static void dmx_timer_sim_deinit(dmx_port_t dmx_num) {
+  dmx_bus_timer_detach(dmx_num);
+}
+
+static void dmx_timer_sim_stop(dmx_port_t dmx_num) {
+  dmx_bus_timer_stop(dmx_num);
+  dmx_bus_timer_set_counter(dmx_num, 0);
+}
+
+static void dmx_timer_sim_set_counter(dmx_port_t dmx_num, uint64_t counter) {
+  dmx_bus_timer_set_counter(dmx_num, counter);
+}
+
+static void dmx_timer_sim_set_alarm(dmx_port_t dmx_num, uint64_t alarm,
+                                    bool auto_reload) {
+  dmx_bus_timer_set_alarm(dmx_num, alarm, auto_reload);
+}
+
+static void dmx_timer_sim_start(dmx_port_t dmx_num) {
+  dmx_bus_timer_start(dmx_num);
+}
+
+int64_t dmx_timer_get_micros_since_boot() { return dmx_bus_get_micros(); }
+
+const dmx_timer_hal_t dmx_timer_hal_default = {
+    .init = dmx_timer_sim_init,
+    .deinit = dmx_timer_sim_deinit,
+    .stop = dmx_timer_sim_stop,
+    .set_counter = dmx_timer_sim_set_counter,
+    .set_alarm = dmx_timer_sim_set_alarm,
+    .start = dmx_timer_sim_start,
+};
+
+#endif  // CONFIG_IDF_TARGET_LINUX
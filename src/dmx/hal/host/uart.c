@@ -0,0 +1,128 @@
+#include "sdkconfig.h"
+
+// Only built for the ESP-IDF linux target. Arduino compiles every source file.
+#ifdef CONFIG_IDF_TARGET_LINUX
+
+#include "dmx/hal/include/uart.h"
+
+#include "dmx/hal/include/isr.h"
+#include "dmx/include/service.h"
+
+#define DMX_UART_FULL_DEFAULT 1
+#define DMX_UART_EMPTY_DEFAULT 8
+
+static bool dmx_uart_sim_init(dmx_port_t dmx_num, void *isr_context,
+                              int isr_flags) {
+  dmx_bus_set_baud_rate(dmx_num, DMX_BAUD_RATE);
+  dmx_bus_set_txfifo_empty_threshold(dmx_num, DMX_UART_EMPTY_DEFAULT);
+  dmx_bus_set_rxfifo_full_threshold(dmx_num, DMX_UART_FULL_DEFAULT);
+  dmx_bus_set_rx_timeout(dmx_num, DMX_UART_TIMEOUT_DEFAULT);
+
+  dmx_bus_rxfifo_reset(dmx_num);
+  dmx_bus_txfifo_reset(dmx_num);
+  dmx_bus_disable_interrupt(dmx_num, DMX_BUS_INTR_MASK);
+  dmx_bus_clear_interrupt(dmx_num, DMX_BUS_INTR_MASK);
+
+  dmx_bus_uart_attach(dmx_num, dmx_uart_isr, isr_context);
+
+  return true;
+}
+
+static void dmx_uart_sim_deinit(dmx_port_t dmx_num) {
+  dmx_bus_uart_detach(dmx_num);
+}
+
+static bool dmx_uart_sim_set_pin(dmx_port_t dmx_num, int tx, int rx, int rts) {
+  return true;  // Every port is connected to the virtual DMX bus
+}
+
+static uint32_t dmx_uart_sim_get_baud_rate(dmx_port_t dmx_num) {
+  return dmx_bus_get_baud_rate(dmx_num);
+}
+
+static void dmx_uart_sim_set_baud_rate(dmx_port_t dmx_num, uint32_t baud_rate) {
+  dmx_bus_set_baud_rate(dmx_num, baud_rate);
+}
+
+static void dmx_uart_sim_set_rxfifo_full_threshold(dmx_port_t dmx_num,
+                                                   int threshold) {
+  dmx_bus_set_rxfifo_full_threshold(dmx_num, threshold);
+}
+
+static void dmx_uart_sim_invert_tx(dmx_port_t dmx_num, int invert) {
+  dmx_bus_invert_tx(dmx_num, invert);
+}
+
+static int dmx_uart_sim_get_rts(dmx_port_t dmx_num) {
+  return dmx_bus_get_rts(dmx_num);
+}
+
+static int dmx_uart_sim_get_interrupt_status(dmx_port_t dmx_num) {
+  return dmx_bus_get_interrupt_status(dmx_num);
+}
+
+static void dmx_uart_sim_enable_interrupt(dmx_port_t dmx_num, int mask) {
+  dmx_bus_enable_interrupt(dmx_num, mask);
+}
+
+static void dmx_uart_sim_disable_interrupt(dmx_port_t dmx_num, int mask) {
+  dmx_bus_disable_interrupt(dmx_num, mask);
+}
+
+static void dmx_uart_sim_clear_interrupt(dmx_port_t dmx_num, int mask) {
+  dmx_bus_clear_interrupt(dmx_num, mask);
+}
+
+static uint32_t dmx_uart_sim_get_rxfifo_len(dmx_port_t dmx_num) {
+  return dmx_bus_get_rxfifo_len(dmx_num);
+}
+
+static void dmx_uart_sim_read_rxfifo(dmx_port_t dmx_num, uint8_t *buf,
+                                     int *size) {
+  dmx_bus_read_rxfifo(dmx_num, buf, size);
+}
+
+static void dmx_uart_sim_set_rts(dmx_port_t dmx_num, int set) {
+  dmx_bus_set_rts(dmx_num, set);
+}
+
+static void dmx_uart_sim_rxfifo_reset(dmx_port_t dmx_num) {
+  dmx_bus_rxfifo_reset(dmx_num);
+}
+
+static uint32_t dmx_uart_sim_get_txfifo_len(dmx_port_t dmx_num) {
+  return dmx_bus_get_txfifo_len(dmx_num);
+}
+
+static void dmx_uart_sim_write_txfifo(dmx_port_t dmx_num, const void *buf,
+                                      int *size) {
+  dmx_bus_write_txfifo(dmx_num, buf, size);
+}
+
+static void dmx_uart_sim_txfifo_reset(dmx_port_t dmx_num) {
+  dmx_bus_txfifo_reset(dmx_num);
+}
+
+const dmx_uart_hal_t dmx_uart_hal_default = {
+    .init = dmx_uart_sim_init,
+    .deinit = dmx_uart_sim_deinit,
+    .set_pin = dmx_uart_sim_set_pin,
+    .get_baud_rate = dmx_uart_sim_get_baud_rate,
+    .set_baud_rate = dmx_uart_sim_set_baud_rate,
+    .set_rxfifo_full_threshold = dmx_uart_sim_set_rxfifo_full_threshold,
+    .invert_tx = dmx_uart_sim_invert_tx,
+    .get_rts = dmx_uart_sim_get_rts,
+    .get_interrupt_status = dmx_uart_sim_get_interrupt_status,
+    .enable_interrupt = dmx_uart_sim_enable_interrupt,
+    .disable_interrupt = dmx_uart_sim_disable_interrupt,
+    .clear_interrupt = dmx_uart_sim_clear_interrupt,
+    .get_rxfifo_len = dmx_uart_sim_get_rxfifo_len,
+    .read_rxfifo = dmx_uart_sim_read_rxfifo,
+    .set_rts = dmx_uart_sim_set_rts,
+    .rxfifo_reset = dmx_uart_sim_rxfifo_reset,
+    .get_txfifo_len = dmx_uart_sim_get_txfifo_len,
+    .write_txfifo = dmx_uart_sim_write_txfifo,
+    .txfifo_reset = dmx_uart_sim_txfifo_reset,
+};
+
+#endif  // CONFIG_IDF_TARGET_LINUX
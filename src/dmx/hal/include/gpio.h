@@ -9,12 +9,24 @@
 #pragma once
 
 #include "dmx/include/types.h"
+#include "esp_attr.h"
+#ifdef CONFIG_IDF_TARGET_LINUX
+#include "dmx/hal/host/include/bus.h"
+#else
 #include "driver/gpio.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_IDF_TARGET_LINUX
+/* The host HAL has no physical pins. Any pin number is accepted and every DMX
+ * sniffer pin observes the virtual DMX bus. */
+#define GPIO_IS_VALID_GPIO(gpio_num) ((gpio_num) >= 0)
+#define GPIO_IS_VALID_OUTPUT_GPIO(gpio_num) ((gpio_num) >= 0)
+#endif
+
 /**
  * @brief Evaluates to true if the pin number used for TX is valid.
  */
@@ -35,6 +47,22 @@ extern "C" {
  */
 #define dmx_sniffer_pin_is_valid(sniffer) (GPIO_IS_VALID_GPIO(sniffer))
 
+/**
+ * @brief The GPIO functions of a DMX HAL backend. These are only used by the
+ * DMX sniffer.
+ */
+typedef struct dmx_gpio_hal_t {
+  bool (*init)(dmx_port_t dmx_num, void *isr_context, int sniffer_pin);
+  void (*deinit)(dmx_port_t dmx_num);
+  int (*read)(dmx_port_t dmx_num);
+} dmx_gpio_hal_t;
+
+/** @brief The GPIO functions which are used by each DMX port.*/
+extern const dmx_gpio_hal_t *dmx_gpio_hal[DMX_NUM_MAX];
+
+/** @brief The GPIO functions of the GPIO peripheral of this target.*/
+extern const dmx_gpio_hal_t dmx_gpio_hal_default;
+
 /**
  * @brief Initializes the GPIO for the DMX sniffer.
  *
@@ -43,14 +71,19 @@ extern "C" {
  * @param sniffer_pin The sniffer pin GPIO number.
  * @return A handle to the DMX GPIO or null on failure.
  */
-bool dmx_gpio_init(dmx_port_t dmx_num, void *isr_context, int sniffer_pin);
+FORCE_INLINE_ATTR bool dmx_gpio_init(dmx_port_t dmx_num, void *isr_context,
+                                     int sniffer_pin) {
+  return dmx_gpio_hal[dmx_num]->init(dmx_num, isr_context, sniffer_pin);
+}
 
 /**
  * @brief De-initializes the GPIO for the DMX sniffer.
  *
  * @param gpio A handle to the DMX GPIO.
  */
-void dmx_gpio_deinit(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_gpio_deinit(dmx_port_t dmx_num) {
+  dmx_gpio_hal[dmx_num]->deinit(dmx_num);
+}
 
 /**
  * @brief Reads the level of the DMX sniffer GPIO.
@@ -58,7 +91,9 @@ void dmx_gpio_deinit(dmx_port_t dmx_num);
  * @param gpio A handle to the DMX GPIO.
  * @return The level of the DMX GPIO.
  */
-int dmx_gpio_read(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR int dmx_gpio_read(dmx_port_t dmx_num) {
+  return dmx_gpio_hal[dmx_num]->read(dmx_num);
+}
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,53 @@
+/**
+ * @file dmx/hal/include/hal.h
+ * @author Mitch Weisbrod (mitch@theweisbrods.com)
+ * @brief This file contains the Hardware Abstraction Layer (HAL) backend
+ * interface of esp_dmx. A HAL backend is a set of UART, timer, and GPIO
+ * functions which the DMX driver calls to drive a DMX port. Each DMX port uses
+ * the backend which was passed to dmx_driver_install() or the peripherals of
+ * this target by default. This file only needs to be included by users who
+ * implement their own HAL backend.
+ */
+#pragma once
+
+#include "dmx/hal/include/gpio.h"
+#include "dmx/hal/include/timer.h"
+#include "dmx/hal/include/uart.h"
+#include "dmx/include/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A DMX HAL backend. The functions of each member are called with the
+ * DMX port number so that one backend may drive several DMX ports. Functions
+ * which are called from the DMX interrupt handlers must be placed in IRAM when
+ * CONFIG_DMX_ISR_IN_IRAM is enabled.
+ */
+struct dmx_hal_t {
+  /** @brief The functions used to send and receive DMX and RDM packets.*/
+  const dmx_uart_hal_t *uart;
+  /** @brief The functions used to generate the DMX break and mark-after-break
+   * and to time RDM packets.*/
+  const dmx_timer_hal_t *timer;
+  /** @brief The functions used by the DMX sniffer.*/
+  const dmx_gpio_hal_t *gpio;
+};
+
+/** @brief The HAL backend which uses the peripherals of this target.*/
+extern const dmx_hal_t dmx_hal_default;
+
+/**
+ * @brief Sets the HAL backend of a DMX port. This is called by
+ * dmx_driver_install() and should not be called while the DMX driver is
+ * installed.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[in] hal A pointer to the HAL backend to use.
+ */
+void dmx_hal_set(dmx_port_t dmx_num, const dmx_hal_t *hal);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file dmx/hal/include/isr.h
+ * @author Mitch Weisbrod (mitch@theweisbrods.com)
+ * @brief This file contains the interrupt service routines (ISR) of esp_dmx.
+ * The ISRs are shared by every Hardware Abstraction Layer (HAL) so that the DMX
+ * and RDM state machines behave identically regardless of which peripherals
+ * are used to drive the DMX bus. This file is not considered part of the API
+ * and should not be included by the user.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "dmx/include/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The DMX UART interrupt service routine. Reads and writes the UART
+ * FIFOs and advances the DMX and RDM packet state machine.
+ *
+ * @param[inout] arg A pointer to the DMX driver of the DMX port.
+ */
+void dmx_uart_isr(void *arg);
+
+/**
+ * @brief The DMX timer interrupt service routine. Generates the DMX break and
+ * mark-after-break when sending and notifies the waiting task when an RDM
+ * timing alarm has elapsed.
+ *
+ * @param[inout] arg A pointer to the DMX driver of the DMX port.
+ * @return true if a higher priority task was woken by the ISR.
+ * @return false if no task was woken.
+ */
+bool dmx_timer_isr(void *arg);
+
+/**
+ * @brief The DMX sniffer GPIO interrupt service routine. Measures the DMX break
+ * and mark-after-break of received DMX packets.
+ *
+ * @param[inout] arg A pointer to the DMX driver of the DMX port.
+ */
+void dmx_gpio_isr(void *arg);
+
+#ifdef __cplusplus
+}
+#endif
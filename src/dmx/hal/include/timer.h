@@ -11,8 +11,11 @@
 #pragma once
 
 #include "dmx/include/types.h"
+#include "esp_attr.h"
 
-#if ESP_IDF_VERSION_MAJOR >= 5
+#ifdef CONFIG_IDF_TARGET_LINUX
+#include "dmx/hal/host/include/bus.h"
+#elif ESP_IDF_VERSION_MAJOR >= 5
 #include "driver/gptimer.h"
 #include "esp_timer.h"
 #else
@@ -48,6 +51,26 @@ enum {
   RDM_TIMING_RESPONDER_INTER_SLOT_MAX = 2000,
 };
 
+/**
+ * @brief The timer functions of a DMX HAL backend. The DMX driver calls these
+ * functions through the dmx_timer_*() functions below. The timer must count at
+ * a resolution of 1MHz.
+ */
+typedef struct dmx_timer_hal_t {
+  bool (*init)(dmx_port_t dmx_num, void *isr_context, int isr_flags);
+  void (*deinit)(dmx_port_t dmx_num);
+  void (*stop)(dmx_port_t dmx_num);
+  void (*set_counter)(dmx_port_t dmx_num, uint64_t counter);
+  void (*set_alarm)(dmx_port_t dmx_num, uint64_t alarm, bool auto_reload);
+  void (*start)(dmx_port_t dmx_num);
+} dmx_timer_hal_t;
+
+/** @brief The timer functions which are used by each DMX port.*/
+extern const dmx_timer_hal_t *dmx_timer_hal[DMX_NUM_MAX];
+
+/** @brief The timer functions of the timer peripheral of this target.*/
+extern const dmx_timer_hal_t dmx_timer_hal_default;
+
 /**
  * @brief Initializes the DMX timer.
  *
@@ -56,21 +79,28 @@ enum {
  * @param isr_flags Interrupt flags to be used for the DMX timer ISR.
  * @return A handle to the DMX timer or NULL on failure.
  */
-bool dmx_timer_init(dmx_port_t dmx_num, void *isr_context, int isr_flags);
+FORCE_INLINE_ATTR bool dmx_timer_init(dmx_port_t dmx_num, void *isr_context,
+                                      int isr_flags) {
+  return dmx_timer_hal[dmx_num]->init(dmx_num, isr_context, isr_flags);
+}
 
 /**
  * @brief De-initializes the DMX timer.
  *
  * @param timer A handle to the DMX timer.
  */
-void dmx_timer_deinit(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_timer_deinit(dmx_port_t dmx_num) {
+  dmx_timer_hal[dmx_num]->deinit(dmx_num);
+}
 
 /**
  * @brief Pauses the DMX timer.
  *
  * @param timer A handle to the DMX timer.
  */
-void dmx_timer_stop(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_timer_stop(dmx_port_t dmx_num) {
+  dmx_timer_hal[dmx_num]->stop(dmx_num);
+}
 
 /**
  * @brief Sets the counter value for the DMX timer.
@@ -78,7 +108,10 @@ void dmx_timer_stop(dmx_port_t dmx_num);
  * @param timer A handle to the DMX timer.
  * @param counter The counter value to which to set the DMX timer.
  */
-void dmx_timer_set_counter(dmx_port_t dmx_num, uint64_t counter);
+FORCE_INLINE_ATTR void dmx_timer_set_counter(dmx_port_t dmx_num,
+                                             uint64_t counter) {
+  dmx_timer_hal[dmx_num]->set_counter(dmx_num, counter);
+}
 
 /**
  * @brief Sets the alarm value for the DMX timer.
@@ -88,14 +121,19 @@ void dmx_timer_set_counter(dmx_port_t dmx_num, uint64_t counter);
  * @param auto_reload Set to true to automatically reload the alarm when the
  * alarm is triggered.
  */
-void dmx_timer_set_alarm(dmx_port_t dmx_num, uint64_t alarm, bool auto_reload);
+FORCE_INLINE_ATTR void dmx_timer_set_alarm(dmx_port_t dmx_num, uint64_t alarm,
+                                           bool auto_reload) {
+  dmx_timer_hal[dmx_num]->set_alarm(dmx_num, alarm, auto_reload);
+}
 
 /**
  * @brief Starts the DMX timer.
  *
  * @param timer A handle to the DMX timer.
  */
-void dmx_timer_start(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_timer_start(dmx_port_t dmx_num) {
+  dmx_timer_hal[dmx_num]->start(dmx_num);
+}
 
 /**
  * @brief Gets the number of microseconds that have elapsed since boot.
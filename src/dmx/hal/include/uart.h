@@ -11,7 +11,23 @@
 #pragma once
 
 #include "dmx/include/types.h"
+#include "dmx/trace.h"
+#include "esp_attr.h"
+#ifdef CONFIG_IDF_TARGET_LINUX
+#include "dmx/hal/host/include/bus.h"
+#else
 #include "hal/uart_hal.h"
+#endif
+
+#ifndef CONFIG_DMX_RX_FIFO_BATCH_SIZE
+/* The maximum number of DMX slots which are buffered in the UART RX FIFO before
+ * the UART ISR is called.*/
+#define CONFIG_DMX_RX_FIFO_BATCH_SIZE (64)
+#endif
+
+/* The number of slot times after the last received slot at which the UART RX
+ * timeout interrupt is raised. */
+#define DMX_UART_TIMEOUT_DEFAULT 2
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,7 +39,9 @@ enum dmx_interrupt_mask_t {
   DMX_INTR_RX_ERR = DMX_INTR_RX_FIFO_OVERFLOW | DMX_INTR_RX_FRAMING_ERR,
 
   DMX_INTR_RX_BREAK = UART_INTR_BRK_DET,
-  DMX_INTR_RX_DATA = UART_INTR_RXFIFO_FULL,
+  DMX_INTR_RX_FULL = UART_INTR_RXFIFO_FULL,
+  DMX_INTR_RX_TIMEOUT = UART_INTR_RXFIFO_TOUT,
+  DMX_INTR_RX_DATA = DMX_INTR_RX_FULL | DMX_INTR_RX_TIMEOUT,
   DMX_INTR_RX_ALL = DMX_INTR_RX_DATA | DMX_INTR_RX_BREAK | DMX_INTR_RX_ERR,
 
   DMX_INTR_TX_DATA = UART_INTR_TXFIFO_EMPTY,
@@ -31,20 +49,59 @@ enum dmx_interrupt_mask_t {
   DMX_INTR_TX_ALL = DMX_INTR_TX_DATA | DMX_INTR_TX_DONE,
 };
 
+/**
+ * @brief The UART functions of a DMX HAL backend. The DMX driver calls these
+ * functions through the dmx_uart_*() functions below. Interrupt masks use the
+ * layout of the DMX interrupt masks above. Functions which are called by the
+ * DMX ISRs must be safe to call from an ISR.
+ */
+typedef struct dmx_uart_hal_t {
+  bool (*init)(dmx_port_t dmx_num, void *isr_context, int isr_flags);
+  void (*deinit)(dmx_port_t dmx_num);
+  bool (*set_pin)(dmx_port_t dmx_num, int tx, int rx, int rts);
+  uint32_t (*get_baud_rate)(dmx_port_t dmx_num);
+  void (*set_baud_rate)(dmx_port_t dmx_num, uint32_t baud_rate);
+  void (*set_rxfifo_full_threshold)(dmx_port_t dmx_num, int threshold);
+  void (*invert_tx)(dmx_port_t dmx_num, int invert);
+  int (*get_rts)(dmx_port_t dmx_num);
+  int (*get_interrupt_status)(dmx_port_t dmx_num);
+  void (*enable_interrupt)(dmx_port_t dmx_num, int mask);
+  void (*disable_interrupt)(dmx_port_t dmx_num, int mask);
+  void (*clear_interrupt)(dmx_port_t dmx_num, int mask);
+  uint32_t (*get_rxfifo_len)(dmx_port_t dmx_num);
+  void (*read_rxfifo)(dmx_port_t dmx_num, uint8_t *buf, int *size);
+  void (*set_rts)(dmx_port_t dmx_num, int set);
+  void (*rxfifo_reset)(dmx_port_t dmx_num);
+  uint32_t (*get_txfifo_len)(dmx_port_t dmx_num);
+  void (*write_txfifo)(dmx_port_t dmx_num, const void *buf, int *size);
+  void (*txfifo_reset)(dmx_port_t dmx_num);
+} dmx_uart_hal_t;
+
+/** @brief The UART functions which are used by each DMX port.*/
+extern const dmx_uart_hal_t *dmx_uart_hal[DMX_NUM_MAX];
+
+/** @brief The UART functions of the UART peripheral of this target.*/
+extern const dmx_uart_hal_t dmx_uart_hal_default;
+
 /**
  * @brief Initializes the UART for DMX.
  *
  * @param[inout] isr_context Context to be used in the DMX UART ISR.
  * @return A handle to the DMX UART or NULL on failure.
  */
-bool dmx_uart_init(dmx_port_t dmx_num, void *isr_context, int isr_flags);
+FORCE_INLINE_ATTR bool dmx_uart_init(dmx_port_t dmx_num, void *isr_context,
+                                     int isr_flags) {
+  return dmx_uart_hal[dmx_num]->init(dmx_num, isr_context, isr_flags);
+}
 
 /**
  * @brief De-initializes the UART.
  *
  * @param uart A handle to the DMX UART.
  */
-void dmx_uart_deinit(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_uart_deinit(dmx_port_t dmx_num) {
+  dmx_uart_hal[dmx_num]->deinit(dmx_num);
+}
 
 /**
  * @brief Sets the pins to be used by the DMX UART.
@@ -56,7 +113,10 @@ void dmx_uart_deinit(dmx_port_t dmx_num);
  * @return true on success.
  * @return false on failure.
  */
-bool dmx_uart_set_pin(dmx_port_t dmx_num, int tx, int rx, int rts);
+FORCE_INLINE_ATTR bool dmx_uart_set_pin(dmx_port_t dmx_num, int tx, int rx,
+                                        int rts) {
+  return dmx_uart_hal[dmx_num]->set_pin(dmx_num, tx, rx, rts);
+}
 
 /**
  * @brief Gets the UART baud rate of the selected UART hardware.
@@ -64,7 +124,9 @@ bool dmx_uart_set_pin(dmx_port_t dmx_num, int tx, int rx, int rts);
  * @param uart A handle to the DMX UART.
  * @return The baud rate of the UART hardware.
  */
-uint32_t dmx_uart_get_baud_rate(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR uint32_t dmx_uart_get_baud_rate(dmx_port_t dmx_num) {
+  return dmx_uart_hal[dmx_num]->get_baud_rate(dmx_num);
+}
 
 /**
  * @brief Sets the baud rate for the UART.
@@ -72,7 +134,23 @@ uint32_t dmx_uart_get_baud_rate(dmx_port_t dmx_num);
  * @param uart A handle to the DMX UART.
  * @param baud_rate The baud rate to use.
  */
-void dmx_uart_set_baud_rate(dmx_port_t dmx_num, uint32_t baud_rate);
+FORCE_INLINE_ATTR void dmx_uart_set_baud_rate(dmx_port_t dmx_num,
+                                              uint32_t baud_rate) {
+  dmx_uart_hal[dmx_num]->set_baud_rate(dmx_num, baud_rate);
+}
+
+/**
+ * @brief Sets the number of bytes in the UART RX FIFO at which the RX FIFO full
+ * interrupt is triggered. Bytes which are below the threshold are flushed by
+ * the UART RX timeout interrupt.
+ *
+ * @param dmx_num The DMX port number.
+ * @param threshold The RX FIFO full threshold.
+ */
+FORCE_INLINE_ATTR void dmx_uart_set_rxfifo_full_threshold(dmx_port_t dmx_num,
+                                                          int threshold) {
+  dmx_uart_hal[dmx_num]->set_rxfifo_full_threshold(dmx_num, threshold);
+}
 
 /**
  * @brief Inverts or un-inverts the TX line on the UART.
@@ -80,7 +158,9 @@ void dmx_uart_set_baud_rate(dmx_port_t dmx_num, uint32_t baud_rate);
  * @param uart A handle to the DMX UART.
  * @param invert_mask 1 to invert, 0 to un-invert.
  */
-void dmx_uart_invert_tx(dmx_port_t dmx_num, int invert);
+FORCE_INLINE_ATTR void dmx_uart_invert_tx(dmx_port_t dmx_num, int invert) {
+  dmx_uart_hal[dmx_num]->invert_tx(dmx_num, invert);
+}
 
 /**
  * @brief Gets the level of the UART RTS line.
@@ -89,7 +169,9 @@ void dmx_uart_invert_tx(dmx_port_t dmx_num, int invert);
  * @return 1 if the UART RTS line is enabled (set low; read), 0 if the UART RTS
  * line is disable (set high; write).
  */
-int dmx_uart_get_rts(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR int dmx_uart_get_rts(dmx_port_t dmx_num) {
+  return dmx_uart_hal[dmx_num]->get_rts(dmx_num);
+}
 
 /**
  * @brief Gets the interrupt status mask from the UART.
@@ -97,7 +179,9 @@ int dmx_uart_get_rts(dmx_port_t dmx_num);
  * @param uart A handle to the DMX UART.
  * @return The interrupt status mask.
  */
-int dmx_uart_get_interrupt_status(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR int dmx_uart_get_interrupt_status(dmx_port_t dmx_num) {
+  return dmx_uart_hal[dmx_num]->get_interrupt_status(dmx_num);
+}
 
 /**
  * @brief Enables UART interrupts using an interrupt mask.
@@ -105,7 +189,9 @@ int dmx_uart_get_interrupt_status(dmx_port_t dmx_num);
  * @param uart A handle to the DMX UART.
  * @param mask The UART mask that is enabled.
  */
-void dmx_uart_enable_interrupt(dmx_port_t dmx_num, int mask);
+FORCE_INLINE_ATTR void dmx_uart_enable_interrupt(dmx_port_t dmx_num, int mask) {
+  dmx_uart_hal[dmx_num]->enable_interrupt(dmx_num, mask);
+}
 
 /**
  * @brief Disables UART interrupts using an interrupt mask.
@@ -113,7 +199,10 @@ void dmx_uart_enable_interrupt(dmx_port_t dmx_num, int mask);
  * @param uart A handle to the DMX UART.
  * @param mask The UART mask that is disabled.
  */
-void dmx_uart_disable_interrupt(dmx_port_t dmx_num, int mask);
+FORCE_INLINE_ATTR void dmx_uart_disable_interrupt(dmx_port_t dmx_num,
+                                                  int mask) {
+  dmx_uart_hal[dmx_num]->disable_interrupt(dmx_num, mask);
+}
 
 /**
  * @brief Clears UART interrupts using a mask.
@@ -121,7 +210,9 @@ void dmx_uart_disable_interrupt(dmx_port_t dmx_num, int mask);
  * @param uart A handle to the DMX UART.
  * @param mask The UART mask that is cleared.
  */
-void dmx_uart_clear_interrupt(dmx_port_t dmx_num, int mask);
+FORCE_INLINE_ATTR void dmx_uart_clear_interrupt(dmx_port_t dmx_num, int mask) {
+  dmx_uart_hal[dmx_num]->clear_interrupt(dmx_num, mask);
+}
 
 /**
  * @brief Gets the current length of the bytes in the UART RX FIFO.
@@ -129,7 +220,9 @@ void dmx_uart_clear_interrupt(dmx_port_t dmx_num, int mask);
  * @param uart A handle to the DMX UART.
  * @return The number of bytes in the UART RX FIFO.
  */
-uint32_t dmx_uart_get_rxfifo_len(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR uint32_t dmx_uart_get_rxfifo_len(dmx_port_t dmx_num) {
+  return dmx_uart_hal[dmx_num]->get_rxfifo_len(dmx_num);
+}
 
 /**
  * @brief Reads from the UART RX FIFO.
@@ -139,7 +232,10 @@ uint32_t dmx_uart_get_rxfifo_len(dmx_port_t dmx_num);
  * @param[inout] num The maximum number of characters to read. Set to 0 to read
  * all data. Is set to the number of characters read.
  */
-void dmx_uart_read_rxfifo(dmx_port_t dmx_num, uint8_t *buf, int *size);
+FORCE_INLINE_ATTR void dmx_uart_read_rxfifo(dmx_port_t dmx_num, uint8_t *buf,
+                                            int *size) {
+  dmx_uart_hal[dmx_num]->read_rxfifo(dmx_num, buf, size);
+}
 
 /**
  * @brief Enables or disables the UART RTS line.
@@ -148,14 +244,19 @@ void dmx_uart_read_rxfifo(dmx_port_t dmx_num, uint8_t *buf, int *size);
  * @param set 1 to enable the UART RTS line (set low; read), 0 to disable the
  * UART RTS line (set high; write).
  */
-void dmx_uart_set_rts(dmx_port_t dmx_num, int set);
+FORCE_INLINE_ATTR void dmx_uart_set_rts(dmx_port_t dmx_num, int set) {
+  DMX_TRACE(dmx_num, DMX_TRACE_RTS, set);
+  dmx_uart_hal[dmx_num]->set_rts(dmx_num, set);
+}
 
 /**
  * @brief Resets the UART RX FIFO.
  *
  * @param uart A handle to the DMX UART.
  */
-void dmx_uart_rxfifo_reset(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_uart_rxfifo_reset(dmx_port_t dmx_num) {
+  dmx_uart_hal[dmx_num]->rxfifo_reset(dmx_num);
+}
 
 /**
  * @brief Gets the length of the UART TX FIFO.
@@ -163,7 +264,9 @@ void dmx_uart_rxfifo_reset(dmx_port_t dmx_num);
  * @param uart A handle to the DMX UART.
  * @return The length of the UART TX FIFO.
  */
-uint32_t dmx_uart_get_txfifo_len(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR uint32_t dmx_uart_get_txfifo_len(dmx_port_t dmx_num) {
+  return dmx_uart_hal[dmx_num]->get_txfifo_len(dmx_num);
+}
 
 /**
  * @brief Writes to the UART TX FIFO.
@@ -173,14 +276,19 @@ uint32_t dmx_uart_get_txfifo_len(dmx_port_t dmx_num);
  * @param[inout] size The number of bytes to write. Is set to the number of
  * bytes written.
  */
-void dmx_uart_write_txfifo(dmx_port_t dmx_num, const void *buf, int *size);
+FORCE_INLINE_ATTR void dmx_uart_write_txfifo(dmx_port_t dmx_num,
+                                             const void *buf, int *size) {
+  dmx_uart_hal[dmx_num]->write_txfifo(dmx_num, buf, size);
+}
 
 /**
  * @brief Resets the UART TX FIFO.
  *
  * @param uart A handle to the DMX UART.
  */
-void dmx_uart_txfifo_reset(dmx_port_t dmx_num);
+FORCE_INLINE_ATTR void dmx_uart_txfifo_reset(dmx_port_t dmx_num) {
+  dmx_uart_hal[dmx_num]->txfifo_reset(dmx_num);
+}
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,710 @@
+#include "include/isr.h"
+
+#include "dmx/hal/include/gpio.h"
+#include "dmx/hal/include/timer.h"
+#include "dmx/hal/include/uart.h"
+#include "dmx/include/service.h"
+#include "dmx/trace.h"
+#include "endian.h"
+#include "rdm/include/driver.h"
+#include "rdm/include/uid.h"
+
+enum {
+  RDM_TYPE_IS_NOT_RDM = 0,  // The packet is not RDM.
+  RDM_TYPE_IS_DISCOVERY,    // The packet is an RDM discovery request.
+  RDM_TYPE_IS_RESPONSE,     // The packet is an RDM response.
+  RDM_TYPE_IS_BROADCAST,    // The packet is a non-discovery RDM broadcast.
+  RDM_TYPE_IS_REQUEST,      // The packet is a standard RDM request.
+  RDM_TYPE_IS_UNKNOWN,  // The packet is RDM, but it is unclear what type it is.
+};
+
+static inline void DMX_ISR_ATTR dmx_stats_begin_update(dmx_driver_t *driver) {
+  // Make the sequence number odd before any statistic is modified
+  __atomic_store_n(&driver->stats.seq, driver->stats.seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void DMX_ISR_ATTR dmx_stats_end_update(dmx_driver_t *driver) {
+  __atomic_store_n(&driver->stats.seq, driver->stats.seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline int DMX_ISR_ATTR dmx_stats_get_bin(uint32_t value, int bins) {
+  // Find the bit length of the value without calling into flash
+  int bin = 0;
+  for (; value > 0 && bin < bins - 1; value >>= 1) {
+    ++bin;
+  }
+  return bin;
+}
+
+static void DMX_ISR_ATTR dmx_stats_record_checksum_error(dmx_driver_t *driver) {
+  if (driver->stats.is_rdm_invalid) {
+    return;  // Only count each packet once
+  }
+  driver->stats.is_rdm_invalid = true;
+  dmx_stats_begin_update(driver);
+  ++driver->stats.values.rdm_checksum_errors;
+  dmx_stats_end_update(driver);
+}
+
+static void DMX_ISR_ATTR dmx_stats_record_packet(dmx_driver_t *driver,
+                                                 int size) {
+  dmx_stats_t *const stats = &driver->stats.values;
+  const uint8_t sc = driver->dmx.data[0];
+  ++stats->start_codes[sc];
+  if (sc != DMX_SC) {
+    return;  // Only DMX packets with a null start code are measured
+  }
+
+  ++stats->packet_count;
+  const int slots = size > 0 ? size - 1 : 0;
+  ++stats->size_histogram[dmx_stats_get_bin(slots >> 5, DMX_STATS_SIZE_BINS)];
+
+  // Measure the time since the DMX break of the previous DMX packet
+  const int64_t last_timestamp = driver->stats.last_packet_timestamp;
+  driver->stats.last_packet_timestamp = driver->dmx.rx_break_timestamp;
+  if (last_timestamp < 0 || driver->dmx.rx_break_timestamp < 0) {
+    return;
+  }
+  const int64_t elapsed = driver->dmx.rx_break_timestamp - last_timestamp;
+  const uint32_t interval = elapsed < UINT32_MAX ? elapsed : UINT32_MAX;
+  ++stats->interval_histogram[dmx_stats_get_bin(interval >> 10,
+                                                DMX_STATS_INTERVAL_BINS)];
+
+  // Update the moving averages, restarting them if the signal was lost
+  if (stats->interval == 0 ||
+      interval > (uint32_t)DMX_TIMEOUT_TICK * portTICK_PERIOD_MS * 1000) {
+    stats->interval = interval;
+    stats->jitter = 0;
+  } else {
+    const int32_t deviation = (int32_t)(interval - stats->interval);
+    const int32_t magnitude = deviation < 0 ? -deviation : deviation;
+    stats->interval += deviation / 8;
+    stats->jitter += (magnitude - (int32_t)stats->jitter) / 8;
+  }
+}
+
+static struct dmx_router_route_t *DMX_ISR_ATTR dmx_router_find(
+    dmx_driver_t *driver, int sc) {
+  dmx_router_t *const router = driver->dmx.router;
+  if (router == NULL) {
+    return NULL;  // No start code has been registered
+  }
+  struct dmx_router_route_t *route = NULL;
+  taskENTER_CRITICAL_ISR(DMX_SPINLOCK(driver->dmx_num));
+  for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+    if (router->routes[i].sc == sc) {
+      route = &router->routes[i];
+      break;
+    }
+  }
+  taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(driver->dmx_num));
+  return route;
+}
+
+static void DMX_ISR_ATTR dmx_router_copy(struct dmx_router_route_t *route,
+                                         const uint8_t *data, int size,
+                                         int *task_awoken) {
+  // Make the sequence number odd while the packet is copied
+  __atomic_store_n(&route->seq, route->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  // Copy four slots at a time without function calls for IRAM ISR
+  const uint32_t *src = (const uint32_t *)data;
+  uint32_t *dest = (uint32_t *)route->data;
+  for (int i = 0; i < (size + 3) / 4; ++i) {
+    dest[i] = src[i];
+  }
+  route->size = size;
+
+  __atomic_store_n(&route->seq, route->seq + 1, __ATOMIC_RELEASE);
+  xSemaphoreGiveFromISR(route->semaphore, task_awoken);
+}
+
+static void DMX_ISR_ATTR dmx_continuous_send(dmx_driver_t *driver,
+                                             int64_t now) {
+  const dmx_port_t dmx_num = driver->dmx_num;
+
+  taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+
+  // Swap in the staged DMX data if no task is currently writing to it
+  if (driver->dmx.staged.is_pending && !driver->dmx.staged.is_locked) {
+    uint8_t *const published = driver->dmx.staged.data;
+    driver->dmx.staged.data = driver->dmx.data == driver->dmx.frame.data
+                                  ? dmx_buffer_get_spare(driver)
+                                  : driver->dmx.data;
+    driver->dmx.data = published;
+    driver->dmx.staged.is_pending = false;
+    driver->dmx.staged.is_stale = true;
+    driver->dmx.staged.dirty_start = 0;
+    driver->dmx.staged.dirty_end = 0;
+    driver->dmx.checksum_len = 0;
+    ++driver->dmx.generation;
+  }
+
+  // Start the DMX break of the next continuous packet
+  driver->dmx.break_timestamp = now;
+  driver->dmx.size = driver->dmx.continuous.size;
+  driver->dmx.head = 0;
+  driver->dmx.progress = DMX_PROGRESS_IN_BREAK;
+  driver->dmx.status = DMX_STATUS_SENDING;
+  dmx_timer_set_counter(dmx_num, 0);
+  dmx_timer_set_alarm(dmx_num, driver->break_len, true);
+  dmx_timer_start(dmx_num);
+  dmx_uart_invert_tx(dmx_num, 1);
+  taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+}
+
+void DMX_ISR_ATTR dmx_uart_isr(void *arg) {
+  const int64_t now = dmx_timer_get_micros_since_boot();
+  dmx_driver_t *const driver = arg;
+  const dmx_port_t dmx_num = driver->dmx_num;
+  int task_awoken = false;
+
+  while (true) {
+    const uint32_t intr_flags = dmx_uart_get_interrupt_status(dmx_num);
+    if (intr_flags == 0) break;
+
+    // DMX Receive ####################################################
+    if (intr_flags & DMX_INTR_RX_ALL) {
+      // Read data into the DMX buffer if there is enough space
+      int dmx_head;
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      dmx_head = driver->dmx.head;
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      if (dmx_head == 0) {
+        driver->stats.is_rdm_invalid = false;  // A new packet is beginning
+      }
+      if (dmx_head >= 0 && dmx_head < DMX_PACKET_SIZE_MAX) {
+        int read_len = DMX_PACKET_SIZE_MAX - dmx_head;
+        dmx_uart_read_rxfifo(dmx_num, &driver->dmx.data[dmx_head], &read_len);
+        const uint8_t *data = driver->dmx.data;
+
+        // Keep a running checksum so RDM packets can be verified in O(1)
+        int checksum_len = dmx_head > 0 ? driver->dmx.checksum_len : 0;
+        uint16_t checksum = checksum_len > 0 ? driver->dmx.checksum : 0;
+        dmx_head += read_len;
+        if (data[0] == RDM_SC) {
+          int checksum_end = dmx_head;
+          if (dmx_head > 2 && data[2] < checksum_end) {
+            checksum_end = data[2];  // Don't include the checksum slots
+          }
+          for (; checksum_len < checksum_end; ++checksum_len) {
+            checksum += data[checksum_len];
+          }
+        }
+
+        /* Slots below the RX FIFO threshold are only read once the RX timeout
+         * elapses, so the last slot arrived one timeout length before now. */
+        int64_t eop_timestamp = driver->dmx.rx_eop_timestamp;
+        if (read_len > 0 && (intr_flags & DMX_INTR_RX_DATA)) {
+          eop_timestamp = now;
+          if (intr_flags & DMX_INTR_RX_TIMEOUT) {
+            eop_timestamp -= driver->rx_timeout_len;
+          }
+        }
+
+        taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        driver->dmx.head = dmx_head;
+        driver->dmx.checksum = checksum;
+        driver->dmx.checksum_len = checksum_len;
+        driver->dmx.rx_eop_timestamp = eop_timestamp;
+        ++driver->dmx.generation;
+        taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      } else {
+        if (dmx_head > 0) {
+          // Record the number of slots received for error reporting
+          dmx_head += dmx_uart_get_rxfifo_len(dmx_num);
+          taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          driver->dmx.head = dmx_head;
+          taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        }
+        dmx_uart_rxfifo_reset(dmx_num);
+      }
+      dmx_uart_clear_interrupt(dmx_num, DMX_INTR_RX_ALL);
+
+      // Handle DMX break condition
+      if (intr_flags & DMX_INTR_RX_BREAK) {
+        // Handle possible condition where expected packet size is too large
+        if (driver->dmx.progress == DMX_PROGRESS_IN_DATA && dmx_head > 0) {
+          taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          driver->dmx.size = dmx_head - 1;  // Attempt to fix packet size
+          driver->dmx.last_rx_break_timestamp = driver->dmx.rx_break_timestamp;
+          driver->dmx.last_rx_eop_timestamp = driver->dmx.rx_eop_timestamp;
+          if (driver->task_waiting && !driver->dmx.window.is_notified) {
+            DMX_TRACE(dmx_num, DMX_TRACE_NOTIFY, DMX_ERR_NOT_ENOUGH_SLOTS);
+            xTaskNotifyFromISR(driver->task_waiting, DMX_ERR_NOT_ENOUGH_SLOTS,
+                               eSetValueWithOverwrite, &task_awoken);
+          }
+          taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          dmx_stats_begin_update(driver);
+          ++driver->stats.values.err_count[DMX_ERR_NOT_ENOUGH_SLOTS];
+          dmx_stats_end_update(driver);
+        }
+
+        // Reset the DMX buffer for the next packet
+        taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        driver->dmx.status = DMX_STATUS_RECEIVING;
+        driver->dmx.progress = DMX_PROGRESS_IN_BREAK;
+        driver->dmx.head = 0;
+        driver->dmx.rx_break_timestamp = now;
+        driver->dmx.window.is_notified = false;
+        if (driver->dmx.data == driver->dmx.frame.data) {
+          // Swap buffers so that the last complete frame is not overwritten
+          driver->dmx.data = dmx_buffer_get_spare(driver);
+          driver->dmx.checksum_len = 0;
+          ++driver->dmx.generation;  // Invalidate the cached RDM header
+        }
+        taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        DMX_TRACE(dmx_num, DMX_TRACE_RX_BREAK, 0);
+        dmx_uart_set_rxfifo_full_threshold(dmx_num, 1);  // Read the start code
+        continue;  // Nothing else to do on DMX break
+      } else if (driver->dmx.progress == DMX_PROGRESS_IN_BREAK ||
+                 driver->dmx.progress == DMX_PROGRESS_IN_MAB) {
+        taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        // UART ISR cannot detect MAB so we go straight to DMX_PROGRESS_IN_DATA
+        driver->dmx.progress = DMX_PROGRESS_IN_DATA;
+        taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      }
+
+      // Guard against notifying multiple times for the same packet
+      if (driver->dmx.progress != DMX_PROGRESS_IN_DATA) {
+        continue;
+      }
+
+      // Process the data depending on the type of packet that was received
+      dmx_err_t err;
+      int rdm_type;
+      bool packet_is_complete;
+      if (intr_flags & DMX_INTR_RX_ERR) {
+        rdm_type = RDM_TYPE_IS_NOT_RDM;
+        packet_is_complete = true;
+        err = intr_flags & DMX_INTR_RX_FIFO_OVERFLOW
+                  ? DMX_ERR_UART_OVERFLOW   // UART overflow
+                  : DMX_ERR_IMPROPER_SLOT;  // Missing stop bits
+      } else {
+        // Determine the type of the packet that was received
+        const uint8_t sc = driver->dmx.data[0];  // DMX start-code.
+        if (sc == RDM_SC) {
+          rdm_type = RDM_TYPE_IS_UNKNOWN;  // Determine actual type later
+        } else if (sc == RDM_PREAMBLE || sc == RDM_DELIMITER) {
+          rdm_type = RDM_TYPE_IS_DISCOVERY;
+        } else {
+          rdm_type = RDM_TYPE_IS_NOT_RDM;
+          taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          // Get the best resolution on the controller EOP timestamp
+          driver->dmx.controller_eop_timestamp = driver->dmx.rx_eop_timestamp;
+          taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        }
+
+        // Set inter-slot timer for RDM response packets
+        if (driver->is_controller && rdm_type != RDM_TYPE_IS_NOT_RDM) {
+          dmx_timer_set_counter(dmx_num, 0);
+          dmx_timer_set_alarm(dmx_num, RDM_TIMING_RESPONDER_INTER_SLOT_MAX,
+                              false);
+        }
+
+        err = DMX_OK;
+      }
+      while (err == DMX_OK) {
+        if (rdm_type == RDM_TYPE_IS_DISCOVERY) {
+          // Parse an RDM discovery response packet
+          if (dmx_head < 17) {
+            packet_is_complete = false;
+            break;  // Haven't received the minimum packet size
+          }
+
+          // Get the delimiter index
+          int delimiter_idx = 0;
+          for (; delimiter_idx <= 7; ++delimiter_idx) {
+            const uint8_t slot_value = driver->dmx.data[delimiter_idx];
+            if (slot_value != RDM_PREAMBLE) {
+              if (slot_value != RDM_DELIMITER) {
+                delimiter_idx = 9;  // Force invalid packet type
+              }
+              break;
+            }
+          }
+          if (delimiter_idx > 8) {
+            rdm_type = RDM_TYPE_IS_NOT_RDM;
+            continue;  // Packet is malformed - treat it as DMX
+          }
+
+          // Process RDM discovery response packet
+          if (dmx_head < delimiter_idx + 17) {
+            packet_is_complete = false;
+            break;  // Haven't received full RDM_PID_DISC_UNIQUE_BRANCH response
+          } else if (!rdm_read_header(dmx_num, NULL)) {
+            dmx_stats_record_checksum_error(driver);
+            rdm_type = RDM_TYPE_IS_NOT_RDM;
+            continue;  // Packet is malformed - treat it as DMX
+          } else {
+            driver->dmx.last_responder_pid = RDM_PID_DISC_UNIQUE_BRANCH;
+            driver->dmx.responder_sent_last = true;
+            packet_is_complete = true;
+            break;
+          }
+        } else if (rdm_type != RDM_TYPE_IS_NOT_RDM) {
+          // Parse a standard RDM packet
+          uint8_t msg_len;
+          if (dmx_head < sizeof(rdm_header_t) + 2) {
+            packet_is_complete = false;
+            break;  // Haven't received full RDM header and checksum yet
+          } else if (driver->dmx.data[1] != RDM_SUB_SC ||
+                     !rdm_cc_is_valid(driver->dmx.data[20]) ||
+                     (msg_len = driver->dmx.data[2]) < sizeof(rdm_header_t)) {
+            rdm_type = RDM_TYPE_IS_NOT_RDM;
+            continue;  // Packet is malformed - treat it as DMX
+          } else if (dmx_head < msg_len + 2) {
+            packet_is_complete = false;
+            break;  // Haven't received full RDM packet and checksum yet
+          } else if (!rdm_read_header(dmx_num, NULL)) {
+            dmx_stats_record_checksum_error(driver);
+            rdm_type = RDM_TYPE_IS_NOT_RDM;
+            continue;  // Packet is malformed - treat it as DMX
+          } else {
+            bool responder_sent_last;
+            const rdm_cc_t cc = driver->dmx.data[20];
+            const rdm_pid_t *pid = (rdm_pid_t *)&driver->dmx.data[21];
+            const rdm_uid_t *uid_ptr = (rdm_uid_t *)&driver->dmx.data[3];
+            const rdm_uid_t dest_uid = {.man_id = bswap16(uid_ptr->man_id),
+                                        .dev_id = bswap32(uid_ptr->dev_id)};
+            if (!rdm_cc_is_request(cc)) {
+              rdm_type = RDM_TYPE_IS_RESPONSE;
+              responder_sent_last = true;
+            } else if (rdm_uid_is_broadcast(&dest_uid)) {
+              rdm_type = RDM_TYPE_IS_BROADCAST;
+              responder_sent_last = false;
+            } else {
+              rdm_type = RDM_TYPE_IS_REQUEST;
+              responder_sent_last = false;
+            }
+            if (!responder_sent_last) {
+              taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+              driver->dmx.controller_eop_timestamp =
+                  driver->dmx.rx_eop_timestamp;
+              driver->dmx.last_controller_pid = bswap16(*pid);
+              taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+            } else {
+              taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+              driver->dmx.last_responder_pid = bswap16(*pid);
+              taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+            }
+            taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+            driver->dmx.responder_sent_last = responder_sent_last;
+            taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+            packet_is_complete = true;
+            break;
+          }
+        } else {
+          // Parse a standard DMX packet
+          // TODO: verify that a data collision hasn't happened
+          taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          driver->dmx.last_controller_pid = 0;
+          driver->dmx.responder_sent_last = false;
+          taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          packet_is_complete = (dmx_head >= driver->dmx.size);
+
+          // Notify the waiting task early once the window has been received
+          taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          if (!packet_is_complete && driver->dmx.window.size > 0 &&
+              dmx_head >= driver->dmx.window.size &&
+              !driver->dmx.window.is_notified && driver->task_waiting &&
+              driver->dmx.data[0] == DMX_SC) {
+            driver->dmx.window.is_notified = true;
+            DMX_TRACE(dmx_num, DMX_TRACE_NOTIFY, DMX_OK);
+            xTaskNotifyFromISR(driver->task_waiting, DMX_OK,
+                               eSetValueWithOverwrite, &task_awoken);
+          }
+
+          // Batch the slots until the next slot which must be acted upon
+          int threshold = driver->dmx.size - dmx_head;
+          if (driver->dmx.window.size > dmx_head &&
+              !driver->dmx.window.is_notified) {
+            threshold = driver->dmx.window.size - dmx_head;
+          }
+          taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+          if (packet_is_complete || threshold > CONFIG_DMX_RX_FIFO_BATCH_SIZE) {
+            threshold = CONFIG_DMX_RX_FIFO_BATCH_SIZE;
+          } else if (threshold < 1) {
+            threshold = 1;
+          }
+          dmx_uart_set_rxfifo_full_threshold(dmx_num, threshold);
+          break;
+        }
+      }
+      if (!packet_is_complete) {
+        continue;
+      }
+      dmx_timer_stop(dmx_num);
+      const int slots =
+          dmx_head < DMX_PACKET_SIZE_MAX ? dmx_head : DMX_PACKET_SIZE_MAX;
+
+      // Route packets with registered start codes out of the DMX buffer
+      struct dmx_router_route_t *route = NULL;
+      if (err == DMX_OK && rdm_type == RDM_TYPE_IS_NOT_RDM) {
+        route = dmx_router_find(driver, driver->dmx.data[0]);
+      }
+      const bool is_diverted = route != NULL && driver->dmx.data[0] != DMX_SC;
+      if (route != NULL) {
+        dmx_router_copy(route, driver->dmx.data, slots, &task_awoken);
+      }
+
+      // Record which slots changed since the previous complete DMX frame
+      if (err == DMX_OK && rdm_type == RDM_TYPE_IS_NOT_RDM && !is_diverted) {
+        const uint32_t *frame = (const uint32_t *)driver->dmx.data;
+        uint32_t *last_frame = driver->dmx.last_frame;
+        const int bitmap_len = (slots + 31) / 32;
+        uint32_t changed[DMX_SLOT_BITMAP_LEN];
+        for (int i = 0; i < bitmap_len; ++i) {
+          changed[i] = 0;
+          for (int j = i * 8; j < i * 8 + 8 && j * 4 < slots; ++j) {
+            /* Compare four slots at a time. The bytes of the final word which
+            are past the end of the packet are masked off so that they don't
+            become the previous values of the slots.*/
+            const int valid = slots - j * 4;
+            const uint32_t mask =
+                valid < 4 ? ((uint32_t)1 << (valid * 8)) - 1 : UINT32_MAX;
+            const uint32_t diff = (frame[j] ^ last_frame[j]) & mask;
+            if (diff == 0) {
+              continue;
+            }
+            for (int k = 0; k < 4; ++k) {
+              if (((const uint8_t *)&diff)[k]) {
+                changed[i] |= (uint32_t)1 << ((j % 8) * 4 + k);
+              }
+            }
+            last_frame[j] ^= diff;
+          }
+        }
+        taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        for (int i = 0; i < bitmap_len; ++i) {
+          driver->dmx.changed_slots[i] |= changed[i];
+        }
+        taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      }
+
+      // Update the receive statistics
+      dmx_stats_begin_update(driver);
+      ++driver->stats.values.err_count[err];
+      if (err == DMX_OK) {
+        dmx_stats_record_packet(driver, slots);
+      }
+      dmx_stats_end_update(driver);
+      DMX_TRACE(dmx_num, DMX_TRACE_RX_PACKET, slots);
+
+      // Set driver flags and notify task
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      const bool is_notified = driver->dmx.window.is_notified;
+      driver->dmx.progress =
+          is_notified ? DMX_PROGRESS_STALE : DMX_PROGRESS_COMPLETE;
+      driver->dmx.status = DMX_STATUS_IDLE;  // Could still be receiving data
+      driver->dmx.last_rx_break_timestamp = driver->dmx.rx_break_timestamp;
+      driver->dmx.last_rx_eop_timestamp = driver->dmx.rx_eop_timestamp;
+      if (err == DMX_OK && rdm_type == RDM_TYPE_IS_NOT_RDM && !is_diverted) {
+        ++driver->dmx.sequence;
+        if (driver->dmx.frame.leases == 0 && driver->rdm.dmx_data == NULL) {
+          // Publish the complete DMX frame
+          driver->dmx.frame.data = driver->dmx.data;
+          driver->dmx.frame.size = dmx_head;
+          driver->dmx.frame.break_timestamp = driver->dmx.rx_break_timestamp;
+          driver->dmx.frame.eop_timestamp = driver->dmx.rx_eop_timestamp;
+          driver->dmx.frame.sequence = driver->dmx.sequence;
+        }
+
+        // Subscribers are woken even if the frame couldn't be published
+        for (int i = 0; i < DMX_SUBSCRIBER_MAX; ++i) {
+          if (driver->subscribers[i].semaphore != NULL) {
+            xSemaphoreGiveFromISR(driver->subscribers[i].semaphore,
+                                  &task_awoken);
+          }
+        }
+      }
+      if (driver->task_waiting && !is_notified) {
+        DMX_TRACE(dmx_num, DMX_TRACE_NOTIFY, err);
+        xTaskNotifyFromISR(driver->task_waiting, err, eSetValueWithOverwrite,
+                           &task_awoken);
+      }
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+    }
+
+    // DMX Transmit #####################################################
+    else if (intr_flags & DMX_INTR_TX_DATA) {
+      // Write data to the UART and clear the interrupt
+      int write_len = driver->dmx.size - driver->dmx.head;
+      dmx_uart_write_txfifo(dmx_num, &driver->dmx.data[driver->dmx.head],
+                            &write_len);
+      driver->dmx.head += write_len;
+      dmx_uart_clear_interrupt(dmx_num, DMX_INTR_TX_DATA);
+
+      // Allow FIFO to empty when done writing data
+      if (driver->dmx.head == driver->dmx.size) {
+        dmx_uart_disable_interrupt(dmx_num, DMX_INTR_TX_DATA);
+      }
+    } else if (intr_flags & DMX_INTR_TX_DONE) {
+      // Disable write interrupts and clear the interrupt
+      dmx_uart_disable_interrupt(dmx_num, DMX_INTR_TX_ALL);
+      dmx_uart_clear_interrupt(dmx_num, DMX_INTR_TX_DONE);
+      DMX_TRACE(dmx_num, DMX_TRACE_TX_DONE, driver->dmx.size);
+
+      // Record the EOP timestamp if this device is the DMX controller
+      if (driver->is_controller) {
+        taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+        driver->dmx.controller_eop_timestamp = now;
+        taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      }
+
+      // Update the DMX status and notify task
+      dmx_send_cb_t send_cb;
+      void *send_cb_context;
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      driver->dmx.progress = DMX_PROGRESS_COMPLETE;
+      driver->dmx.status = DMX_STATUS_IDLE;
+      if (driver->task_waiting) {
+        DMX_TRACE(dmx_num, DMX_TRACE_NOTIFY, DMX_OK);
+        xTaskNotifyFromISR(driver->task_waiting, DMX_OK, eNoAction,
+                           &task_awoken);
+      }
+      send_cb = driver->dmx.send_cb.callback;
+      send_cb_context = driver->dmx.send_cb.context;
+      driver->dmx.send_cb.callback = NULL;  // Only call the callback once
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+
+      // Call the completion callback of a packet sent with dmx_send_async()
+      if (send_cb != NULL &&
+          send_cb(dmx_num, driver->dmx.size, send_cb_context)) {
+        task_awoken = true;
+      }
+
+      // Schedule the next packet if DMX is being sent continuously
+      if (driver->dmx.continuous.is_enabled) {
+        const int64_t elapsed = now - driver->dmx.break_timestamp;
+        if (elapsed < driver->dmx.continuous.period) {
+          dmx_timer_set_counter(dmx_num, elapsed);
+          dmx_timer_set_alarm(dmx_num, driver->dmx.continuous.period, false);
+          dmx_timer_start(dmx_num);
+        } else {
+          dmx_continuous_send(driver, now);
+        }
+        continue;
+      }
+
+      // Skip the rest of the ISR loop if an RDM response is not expected
+      if (!driver->is_controller || driver->dmx.last_controller_pid == 0 ||
+          (driver->dmx.last_request_was_broadcast &&
+           driver->dmx.last_controller_pid != RDM_PID_DISC_UNIQUE_BRANCH)) {
+        continue;
+      }
+
+      // Determine if a DMX break is expected in the response packet
+      int progress;
+      if (driver->dmx.last_controller_pid == RDM_PID_DISC_UNIQUE_BRANCH) {
+        progress = DMX_PROGRESS_IN_DATA;
+        driver->dmx.head = 0;  // Not expecting a DMX break
+        driver->dmx.rx_break_timestamp = -1;
+      } else {
+        progress = DMX_PROGRESS_STALE;
+        driver->dmx.head = DMX_HEAD_WAITING_FOR_BREAK;
+      }
+
+      // Flip the DMX bus so the response may be read
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      dmx_uart_rxfifo_reset(dmx_num);
+      dmx_uart_set_rxfifo_full_threshold(dmx_num, 1);
+      dmx_uart_set_rts(dmx_num, 1);
+      driver->dmx.progress = progress;
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+    }
+  }
+
+  if (task_awoken) portYIELD_FROM_ISR();
+}
+
+bool DMX_ISR_ATTR dmx_timer_isr(void *arg) {
+  dmx_driver_t *const driver = (dmx_driver_t *)arg;
+  const dmx_port_t dmx_num = driver->dmx_num;
+  int task_awoken = false;
+
+  DMX_TRACE(dmx_num, DMX_TRACE_TIMER_ALARM, driver->dmx.progress);
+  if (driver->dmx.status == DMX_STATUS_SENDING) {
+    if (driver->dmx.progress == DMX_PROGRESS_IN_SPACING) {
+      // Start the DMX break of a packet which was sent with dmx_send_async()
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      driver->dmx.progress = DMX_PROGRESS_IN_BREAK;
+      if (driver->is_controller) {
+        driver->dmx.break_timestamp = dmx_timer_get_micros_since_boot();
+      }
+      dmx_timer_set_counter(dmx_num, 0);
+      dmx_timer_set_alarm(dmx_num, driver->break_len, true);
+      dmx_uart_invert_tx(dmx_num, 1);
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+    } else if (driver->dmx.progress == DMX_PROGRESS_IN_BREAK) {
+      dmx_uart_invert_tx(dmx_num, 0);
+      driver->dmx.progress = DMX_PROGRESS_IN_MAB;
+
+      // Reset the alarm for the end of the DMX mark-after-break
+      dmx_timer_set_alarm(dmx_num, driver->mab_len, false);
+    } else {
+      // Write data to the UART
+      int write_len = driver->dmx.size;
+      dmx_uart_write_txfifo(dmx_num, driver->dmx.data, &write_len);
+      driver->dmx.head = write_len;
+
+      // Pause MAB timer alarm
+      dmx_timer_stop(dmx_num);  // TODO: is this needed?
+
+      // Enable DMX write interrupts
+      dmx_uart_enable_interrupt(dmx_num, DMX_INTR_TX_ALL);
+    }
+  } else if (driver->dmx.continuous.is_enabled) {
+    dmx_continuous_send(driver, dmx_timer_get_micros_since_boot());
+  } else {
+    taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+    if (driver->task_waiting) {
+      DMX_TRACE(dmx_num, DMX_TRACE_NOTIFY, DMX_OK);
+      xTaskNotifyFromISR(driver->task_waiting, DMX_OK, eSetValueWithOverwrite,
+                         &task_awoken);
+    }
+    taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+    dmx_timer_stop(dmx_num);  // TODO: is this needed?
+  }
+
+  return task_awoken;
+}
+
+void DMX_ISR_ATTR dmx_gpio_isr(void *arg) {
+  const int64_t now = dmx_timer_get_micros_since_boot();
+  dmx_driver_t *const driver = (dmx_driver_t *)arg;
+  const dmx_port_t dmx_num = driver->dmx_num;
+
+  if (dmx_gpio_read(dmx_num)) {
+    /* If this ISR is called on a positive edge and the current DMX frame is in
+    a break and a negative edge timestamp has been recorded then a break has
+    just finished. Therefore the DMX break length is able to be recorded. It can
+    also be deduced that the driver is now in a DMX mark-after-break. */
+
+    if (driver->dmx.progress == DMX_PROGRESS_IN_BREAK &&
+        driver->sniffer.last_neg_edge_ts > -1) {
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      driver->sniffer.buffer_index = !driver->sniffer.buffer_index;
+      driver->sniffer.metadata[driver->sniffer.buffer_index].break_len =
+          now - driver->sniffer.last_neg_edge_ts;
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      driver->dmx.progress = DMX_PROGRESS_IN_MAB;
+    }
+    driver->sniffer.last_pos_edge_ts = now;
+  } else {
+    /* If this ISR is called on a negative edge in a DMX mark-after-break then
+    the DMX mark-after-break has just finished. It can be recorded. Sniffer data
+    is now available to be read by the user. */
+
+    if (driver->dmx.progress == DMX_PROGRESS_IN_MAB) {
+      taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      driver->sniffer.metadata[driver->sniffer.buffer_index].mab_len =
+          now - driver->sniffer.last_pos_edge_ts;
+      taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
+      driver->dmx.progress = DMX_PROGRESS_IN_DATA;
+    }
+    driver->sniffer.last_neg_edge_ts = now;
+  }
+}
@@ -2,9 +2,8 @@
 
 #include <stdbool.h>
 
-#include "dmx/hal/include/uart.h"
+#include "dmx/hal/include/isr.h"
 #include "dmx/include/service.h"
-#include "driver/gpio.h"
 
 static struct dmx_timer_t {
 #if ESP_IDF_VERSION_MAJOR >= 5
@@ -16,49 +15,16 @@ static struct dmx_timer_t {
   bool is_running;
 } dmx_timer_context[DMX_NUM_MAX] = {};
 
-static bool DMX_ISR_ATTR dmx_timer_isr(
 #if ESP_IDF_VERSION_MAJOR >= 5
+static bool DMX_ISR_ATTR dmx_gptimer_isr(
     gptimer_handle_t gptimer_handle,
-    const gptimer_alarm_event_data_t *event_data,
-#endif
-    void *arg) {
-  dmx_driver_t *const driver = (dmx_driver_t *)arg;
-  const dmx_port_t dmx_num = driver->dmx_num;
-  int task_awoken = false;
-
-  if (driver->dmx.status == DMX_STATUS_SENDING) {
-    if (driver->dmx.progress == DMX_PROGRESS_IN_BREAK) {
-      dmx_uart_invert_tx(dmx_num, 0);
-      driver->dmx.progress = DMX_PROGRESS_IN_MAB;
-
-      // Reset the alarm for the end of the DMX mark-after-break
-      dmx_timer_set_alarm(dmx_num, driver->mab_len, false);
-    } else {
-      // Write data to the UART
-      int write_len = driver->dmx.size;
-      dmx_uart_write_txfifo(dmx_num, driver->dmx.data, &write_len);
-      driver->dmx.head = write_len;
-
-      // Pause MAB timer alarm
-      dmx_timer_stop(dmx_num);  // TODO: is this needed?
-
-      // Enable DMX write interrupts
-      dmx_uart_enable_interrupt(dmx_num, DMX_INTR_TX_ALL);
-    }
-  } else {
-    taskENTER_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
-    if (driver->task_waiting) {
-      xTaskNotifyFromISR(driver->task_waiting, DMX_OK, eSetValueWithOverwrite,
-                         &task_awoken);
-    }
-    taskEXIT_CRITICAL_ISR(DMX_SPINLOCK(dmx_num));
-    dmx_timer_stop(dmx_num);  // TODO: is this needed?
-  }
-
-  return task_awoken;
+    const gptimer_alarm_event_data_t *event_data, void *arg) {
+  return dmx_timer_isr(arg);
 }
+#endif
 
-bool dmx_timer_init(dmx_port_t dmx_num, void *isr_context, int isr_flags) {
+static bool dmx_timer_esp_init(dmx_port_t dmx_num, void *isr_context,
+                               int isr_flags) {
   struct dmx_timer_t *timer = &dmx_timer_context[dmx_num];
 
   // Initialize hardware timer
@@ -72,7 +38,7 @@ bool dmx_timer_init(dmx_port_t dmx_num, void *isr_context, int isr_flags) {
   if (err) {
     return NULL;
   }
-  const gptimer_event_callbacks_t gptimer_cb = {.on_alarm = dmx_timer_isr};
+  const gptimer_event_callbacks_t gptimer_cb = {.on_alarm = dmx_gptimer_isr};
   gptimer_register_event_callbacks(timer->gptimer_handle, &gptimer_cb,
                                    isr_context);
   gptimer_enable(timer->gptimer_handle);
@@ -102,7 +68,7 @@ bool dmx_timer_init(dmx_port_t dmx_num, void *isr_context, int isr_flags) {
   return true;
 }
 
-void dmx_timer_deinit(dmx_port_t dmx_num) {
+static void dmx_timer_esp_deinit(dmx_port_t dmx_num) {
   struct dmx_timer_t *timer = &dmx_timer_context[dmx_num];
 #if ESP_IDF_VERSION_MAJOR >= 5
   gptimer_disable(timer->gptimer_handle);
@@ -114,7 +80,7 @@ void dmx_timer_deinit(dmx_port_t dmx_num) {
   timer->is_running = false;
 }
 
-void DMX_ISR_ATTR dmx_timer_stop(dmx_port_t dmx_num) {
+static void DMX_ISR_ATTR dmx_timer_esp_stop(dmx_port_t dmx_num) {
   struct dmx_timer_t *timer = &dmx_timer_context[dmx_num];
   if (timer->is_running) {
 #if ESP_IDF_VERSION_MAJOR >= 5
@@ -127,7 +93,8 @@ void DMX_ISR_ATTR dmx_timer_stop(dmx_port_t dmx_num) {
   }
 }
 
-void DMX_ISR_ATTR dmx_timer_set_counter(dmx_port_t dmx_num, uint64_t counter) {
+static void DMX_ISR_ATTR dmx_timer_esp_set_counter(dmx_port_t dmx_num,
+                                                   uint64_t counter) {
   struct dmx_timer_t *timer = &dmx_timer_context[dmx_num];
 #if ESP_IDF_VERSION_MAJOR >= 5
   gptimer_set_raw_count(timer->gptimer_handle, counter);
@@ -136,8 +103,9 @@ void DMX_ISR_ATTR dmx_timer_set_counter(dmx_port_t dmx_num, uint64_t counter) {
 #endif
 }
 
-void DMX_ISR_ATTR dmx_timer_set_alarm(dmx_port_t dmx_num, uint64_t alarm,
-                                      bool auto_reload) {
+static void DMX_ISR_ATTR dmx_timer_esp_set_alarm(dmx_port_t dmx_num,
+                                                 uint64_t alarm,
+                                                 bool auto_reload) {
   struct dmx_timer_t *timer = &dmx_timer_context[dmx_num];
 #if ESP_IDF_VERSION_MAJOR >= 5
   const gptimer_alarm_config_t alarm_config = {
@@ -150,7 +118,7 @@ void DMX_ISR_ATTR dmx_timer_set_alarm(dmx_port_t dmx_num, uint64_t alarm,
 #endif
 }
 
-void DMX_ISR_ATTR dmx_timer_start(dmx_port_t dmx_num) {
+static void DMX_ISR_ATTR dmx_timer_esp_start(dmx_port_t dmx_num) {
   struct dmx_timer_t *timer = &dmx_timer_context[dmx_num];
   if (!timer->is_running) {
 #if ESP_IDF_VERSION_MAJOR >= 5
@@ -164,4 +132,13 @@ void DMX_ISR_ATTR dmx_timer_start(dmx_port_t dmx_num) {
 
 int64_t DMX_ISR_ATTR dmx_timer_get_micros_since_boot() {
   return esp_timer_get_time();
-}
\ No newline at end of file
+}
+
+const dmx_timer_hal_t dmx_timer_hal_default DMX_ISR_DATA_ATTR = {
+    .init = dmx_timer_esp_init,
+    .deinit = dmx_timer_esp_deinit,
+    .stop = dmx_timer_esp_stop,
+    .set_counter = dmx_timer_esp_set_counter,
+    .set_alarm = dmx_timer_esp_set_alarm,
+    .start = dmx_timer_esp_start,
+};
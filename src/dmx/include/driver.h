@@ -197,7 +197,10 @@ uint32_t dmx_set_mab_len(dmx_port_t dmx_num, uint32_t mab_len);
 /**
  * @brief Reads DMX data from the driver into a destination buffer with an
  * offset. This can be useful when a receiving DMX device only needs to process
- * a small footprint of the DMX packet.
+ * a small footprint of the DMX packet. On a receiving port, the slots are read
+ * from the last complete DMX frame, or from the DMX packet being received if
+ * every requested slot of it has already arrived. Slots of two different DMX
+ * packets are never mixed.
  *
  * @param dmx_num The DMX port number.
  * @param offset The number of slots with which to offset the read. If set to 0
@@ -211,7 +214,9 @@ size_t dmx_read_offset(dmx_port_t dmx_num, size_t offset, void *destination,
                        size_t size);
 
 /**
- * @brief Reads DMX data from the driver into a destination buffer.
+ * @brief Reads DMX data from the driver into a destination buffer. On a
+ * receiving port, the last complete DMX frame is read, as described in
+ * dmx_read_offset().
  *
  * @param dmx_num The DMX port number.
  * @param[out] destination The destination buffer into which to read the DMX
@@ -230,11 +235,132 @@ size_t dmx_read(dmx_port_t dmx_num, void *destination, size_t size);
  */
 int dmx_read_slot(dmx_port_t dmx_num, size_t slot_num);
 
+/**
+ * @brief Leases the last complete DMX frame that was received by the DMX
+ * driver. The frame is read in place without copying. The DMX driver receives
+ * new packets into a second buffer and does not modify or replace the leased
+ * frame until it is released, so the frame is never torn. Every call to this
+ * function must be matched with a call to dmx_frame_release(). Frames should be
+ * released promptly as new frames are not published while a frame is leased.
+ *
+ * @note Only DMX packets which were received without errors are published as
+ * frames. RDM packets are not published.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] frame A pointer to a dmx_frame_t which receives the frame.
+ * @return true if a frame was leased.
+ * @return false if no frame has been received or on failure.
+ */
+bool dmx_frame_acquire(dmx_port_t dmx_num, dmx_frame_t *frame);
+
+/**
+ * @brief Releases a DMX frame that was leased with dmx_frame_acquire().
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_frame_release(dmx_port_t dmx_num);
+
+/**
+ * @brief Subscribes to the DMX frames which are received by the DMX driver.
+ * Each subscriber is woken by dmx_frame_wait() for every DMX packet that the
+ * DMX driver receives without errors, so several tasks may consume the same DMX
+ * frames without taking turns calling dmx_receive(). The DMX driver must be
+ * receiving DMX for subscribers to be woken.
+ *
+ * @param dmx_num The DMX port number.
+ * @return The subscriber number or -1 on failure.
+ */
+int dmx_frame_subscribe(dmx_port_t dmx_num);
+
+/**
+ * @brief Removes a subscriber which was added with dmx_frame_subscribe(). A
+ * task which is waiting in dmx_frame_wait() with the same subscriber number is
+ * woken and returns false.
+ *
+ * @param dmx_num The DMX port number.
+ * @param subscriber The subscriber number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_frame_unsubscribe(dmx_port_t dmx_num, int subscriber);
+
+/**
+ * @brief Blocks until the DMX driver receives a DMX packet which is newer than
+ * the last packet that the subscriber was woken for. This function returns
+ * immediately if such a packet was received since the subscriber last called
+ * this function. The frame may then be read with dmx_frame_acquire() or
+ * dmx_read(). Each subscriber number should only be used by one task.
+ *
+ * @note Subscribers are woken for every DMX packet, but new frames are not
+ * published while a frame is leased with dmx_frame_acquire() or while an RDM
+ * request is sent. The sequence number of a leased frame is then older than the
+ * sequence number which is returned by this function.
+ *
+ * @param dmx_num The DMX port number.
+ * @param subscriber The subscriber number.
+ * @param[out] sequence An optional pointer which receives the sequence number
+ * of the newest DMX packet. Packets were missed if it is more than one greater
+ * than the previous sequence number.
+ * @param wait_ticks The number of ticks to wait before this function times out.
+ * @return true if a new DMX packet was received.
+ * @return false on timeout, if the subscriber was removed, or on failure.
+ */
+bool dmx_frame_wait(dmx_port_t dmx_num, int subscriber, uint32_t *sequence,
+                    TickType_t wait_ticks);
+
+/**
+ * @brief Reads a bitmap of the DMX slots which changed since the bitmap was
+ * last read. Each complete DMX frame that is received is compared against the
+ * previous complete DMX frame and the slots which differ are added to the
+ * bitmap. The bitmap is cleared after it is read. Every slot is flagged as
+ * changed after the DMX driver is installed.
+ *
+ * @note Only DMX packets which were received without errors are compared. RDM
+ * packets are ignored.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] bitmap An array of DMX_SLOT_BITMAP_LEN words into which to copy
+ * the bitmap. Bit N corresponds to slot N.
+ * @return true if any slots changed.
+ * @return false if no slots changed or on failure.
+ */
+bool dmx_read_changed_slots(dmx_port_t dmx_num, uint32_t *bitmap);
+
+/**
+ * @brief Finds the next range of consecutive changed slots in a bitmap that
+ * was read with dmx_read_changed_slots(). The bitmap is searched one word at a
+ * time so that unchanged slots are skipped quickly.
+ *
+ * @code
+ * uint32_t changed[DMX_SLOT_BITMAP_LEN];
+ * dmx_read_changed_slots(DMX_NUM_1, changed);
+ * size_t size;
+ * for (int slot = dmx_find_changed_slots(changed, 0, &size); slot >= 0;
+ *      slot = dmx_find_changed_slots(changed, slot + size, &size)) {
+ *   // Slots slot through slot + size - 1 changed
+ * }
+ * @endcode
+ *
+ * @param[in] bitmap The bitmap of changed slots.
+ * @param slot_num The slot number at which to begin searching.
+ * @param[out] size The number of consecutive changed slots which were found.
+ * @return The slot number of the first changed slot in the range or -1 if no
+ * more slots changed.
+ */
+int dmx_find_changed_slots(const uint32_t *bitmap, size_t slot_num,
+                           size_t *size);
+
 /**
  * @brief Writes DMX data from a source buffer into the DMX driver buffer with
  * an offset. Allows a source buffer to be written to a specific slot number in
  * the DMX driver buffer.
  *
+ * Data is written into a staged buffer and is published when the next DMX
+ * packet is sent. Writes never modify a DMX packet which is currently being
+ * sent, so it is safe to write while the DMX driver is sending.
+ *
  * @param dmx_num The DMX port number.
  * @param offset The number of slots with which to offset the write. If set to 0
  * this function is equivalent to dmx_write().
@@ -265,6 +391,171 @@ size_t dmx_write(dmx_port_t dmx_num, const void *source, size_t size);
  */
 int dmx_write_slot(dmx_port_t dmx_num, size_t slot_num, uint8_t value);
 
+/**
+ * @brief Writes a list of non-contiguous ranges of DMX data into the DMX driver
+ * buffer. The ranges are validated once and are published together, so the
+ * next DMX packet contains either all or none of the ranges. This is faster
+ * than calling dmx_write_offset() for each range.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[in] vec A pointer to an array of ranges to write. Ranges which extend
+ * past the end of the DMX packet are truncated.
+ * @param num The number of ranges in the array.
+ * @return The total number of bytes written into the DMX driver or 0 on error.
+ */
+size_t dmx_write_scatter(dmx_port_t dmx_num, const dmx_iovec_t *vec,
+                         size_t num);
+
+/**
+ * @brief Starts fading a range of DMX slots from their current values to a
+ * list of target values. Fades are evaluated by the DMX driver each time a DMX
+ * packet is sent with dmx_send(), dmx_send_num(), or dmx_send_group(), so the
+ * application does not need to write each step of the fade. Fades are not
+ * evaluated while DMX is sent continuously, so fades cannot be started while
+ * continuous mode is enabled and continuous mode cannot be enabled while a fade
+ * is active. Starting a fade on a slot which is already fading restarts the
+ * fade from the slot's current value. Writing to a slot which is fading does
+ * not stop the fade.
+ *
+ * @param dmx_num The DMX port number.
+ * @param offset The slot number at which the range of slots begins.
+ * @param[in] targets The target value of each slot in the range.
+ * @param size The number of slots in the range.
+ * @param duration_ms The duration of the fade in milliseconds. If set to 0, the
+ * target values are written immediately.
+ * @return The number of slots which are fading or 0 on error.
+ */
+size_t dmx_fade_start(dmx_port_t dmx_num, size_t offset, const void *targets,
+                      size_t size, uint32_t duration_ms);
+
+/**
+ * @brief Stops fading a range of DMX slots. The slots hold their current
+ * values.
+ *
+ * @param dmx_num The DMX port number.
+ * @param offset The slot number at which the range of slots begins.
+ * @param size The number of slots in the range.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_fade_stop(dmx_port_t dmx_num, size_t offset, size_t size);
+
+/**
+ * @brief Returns true if any DMX slots are fading.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true if any DMX slots are fading.
+ * @return false if no DMX slots are fading.
+ */
+bool dmx_fade_is_active(dmx_port_t dmx_num);
+
+/**
+ * @brief Patches a logical slot to a physical slot. Once a slot is patched,
+ * DMX data which is written with dmx_write(), dmx_write_offset(),
+ * dmx_write_slot(), dmx_write_scatter(), dmx_merge_write(), and
+ * dmx_fade_start() is addressed by logical slot and is remapped to physical
+ * slots as it is written. Logical slots which are not patched are not written.
+ * DMX data that is read with dmx_read() is not remapped. The start code is
+ * never remapped.
+ *
+ * @param dmx_num The DMX port number.
+ * @param logical The logical slot number, from 1 to 512.
+ * @param physical The physical slot number, from 1 to 512, or 0 to unpatch the
+ * logical slot.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_patch_set(dmx_port_t dmx_num, size_t logical, size_t physical);
+
+/**
+ * @brief Patches a 16-bit logical channel, which uses two consecutive logical
+ * slots, to a coarse and a fine physical slot. This allows fixtures whose fine
+ * slot does not directly follow the coarse slot to be patched.
+ *
+ * @param dmx_num The DMX port number.
+ * @param logical The logical slot number of the coarse byte. The fine byte is
+ * the following logical slot.
+ * @param coarse The physical slot number of the coarse byte.
+ * @param fine The physical slot number of the fine byte.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_patch_set_16bit(dmx_port_t dmx_num, size_t logical, size_t coarse,
+                         size_t fine);
+
+/**
+ * @brief Removes the patch of the DMX driver. DMX data is then written to the
+ * slots to which it is addressed.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_patch_clear(dmx_port_t dmx_num);
+
+/**
+ * @brief Writes DMX data into one of the sources of the merge engine of the
+ * DMX driver. Sources are merged each time a DMX packet is sent with
+ * dmx_send(), dmx_send_num(), or dmx_send_group(). While any source is merged,
+ * the merged DMX data replaces the DMX data written with dmx_write() in each
+ * slot which has been written to any source. Other slots keep the DMX data
+ * written with dmx_write(). Sources are not merged while DMX is sent
+ * continuously, so sources cannot be written while continuous mode is enabled
+ * and continuous mode cannot be enabled while a source is merged.
+ *
+ * Only the sources with the highest priority are merged. Each slot is merged
+ * highest takes precedence (HTP) unless it is set to latest takes precedence
+ * (LTP) with dmx_merge_set_policy().
+ *
+ * @param dmx_num The DMX port number.
+ * @param source_num The source number, less than DMX_MERGE_SOURCE_MAX.
+ * @param offset The slot number at which to begin writing.
+ * @param[in] source The DMX data which is copied to the merge source.
+ * @param size The size of the DMX data.
+ * @return The number of bytes written into the merge source or 0 on error.
+ */
+size_t dmx_merge_write(dmx_port_t dmx_num, int source_num, size_t offset,
+                       const void *source, size_t size);
+
+/**
+ * @brief Stops merging a source. The DMX data of the source is cleared.
+ *
+ * @param dmx_num The DMX port number.
+ * @param source_num The source number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_merge_release(dmx_port_t dmx_num, int source_num);
+
+/**
+ * @brief Sets the priority of a merge source. Only the sources with the
+ * highest priority are merged. Sources have a priority of 0 by default. The
+ * priority cannot be set while continuous mode is enabled.
+ *
+ * @param dmx_num The DMX port number.
+ * @param source_num The source number.
+ * @param priority The priority of the source.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_merge_set_priority(dmx_port_t dmx_num, int source_num,
+                            uint8_t priority);
+
+/**
+ * @brief Sets the merge policy of a range of slots. Slots are merged highest
+ * takes precedence by default. The policy cannot be set while continuous mode
+ * is enabled.
+ *
+ * @param dmx_num The DMX port number.
+ * @param offset The slot number at which the range of slots begins.
+ * @param size The number of slots in the range.
+ * @param policy The merge policy, either DMX_MERGE_HTP or DMX_MERGE_LTP.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_merge_set_policy(dmx_port_t dmx_num, size_t offset, size_t size,
+                          int policy);
+
 /**
  * @brief Receives a DMX packet of a specified size from the DMX bus. This is a
  * blocking function. This function first blocks until the DMX driver is idle
@@ -308,6 +599,88 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
 size_t dmx_receive(dmx_port_t dmx_num, dmx_packet_t *packet,
                    TickType_t wait_ticks);
 
+/**
+ * @brief Receives a DMX packet from the DMX bus but returns as soon as the
+ * slots covering the footprint of the current DMX personality have been
+ * received. The footprint is found using dmx_get_start_address() and
+ * dmx_get_footprint(). The DMX driver continues to receive the rest of the
+ * packet in the background, so the returned size may be less than the size of
+ * the packet and the end-of-packet timestamp may be -1. Packets which do not
+ * use the null start code, and devices which do not use a DMX start address,
+ * are received the same as with dmx_receive().
+ *
+ * @note This function uses FreeRTOS direct-to-task notifications to block and
+ * unblock. Using task notifications on the same task that calls this function
+ * can lead to undesired behavior and program instability.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] packet An optional pointer to a dmx_packet_t which contains
+ * information about the received DMX packet.
+ * @param wait_ticks The number of ticks to wait before this function times out.
+ * @return The number of slots that were received or 0 if no packet was
+ * received.
+ */
+size_t dmx_receive_footprint(dmx_port_t dmx_num, dmx_packet_t *packet,
+                             TickType_t wait_ticks);
+
+/**
+ * @brief Copies a snapshot of the receive statistics of the DMX driver. The
+ * statistics are updated by the DMX driver as packets are received and are
+ * copied without blocking the DMX driver, so this function is cheap enough to
+ * be called several times per second. The refresh rate is 0 if no DMX packet
+ * with a null start code has been received within the DMX receive timeout.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] stats A pointer into which to copy the receive statistics.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_get_stats(dmx_port_t dmx_num, dmx_stats_t *stats);
+
+/**
+ * @brief Registers a start code so that packets with that start code are routed
+ * into a separate buffer as they are received. Packets with a registered
+ * alternate start code are not published as DMX frames and do not mark slots
+ * as changed, so they never disrupt the null start code data path. Packets
+ * with the null start code may also be registered; they are published as DMX
+ * frames as usual.
+ *
+ * @param dmx_num The DMX port number.
+ * @param sc The start code to register. RDM start codes may not be registered.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_start_code_register(dmx_port_t dmx_num, uint8_t sc);
+
+/**
+ * @brief Unregisters a start code which was registered with
+ * dmx_start_code_register().
+ *
+ * @param dmx_num The DMX port number.
+ * @param sc The start code to unregister.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_start_code_unregister(dmx_port_t dmx_num, uint8_t sc);
+
+/**
+ * @brief Receives a packet with a registered start code. This function returns
+ * immediately if a packet with the start code was received since the last time
+ * it was called, otherwise it blocks until one is received. The packet is
+ * copied into the destination buffer, beginning with the start code. Each
+ * start code should only be received by one task.
+ *
+ * @param dmx_num The DMX port number.
+ * @param sc The registered start code to receive.
+ * @param[out] destination The buffer into which to copy the packet.
+ * @param size The size of the destination buffer.
+ * @param wait_ticks The number of ticks to wait before this function times out.
+ * @return The number of bytes copied or 0 on timeout or failure.
+ */
+size_t dmx_receive_start_code(dmx_port_t dmx_num, uint8_t sc,
+                              void *destination, size_t size,
+                              TickType_t wait_ticks);
+
 /**
  * @brief Sends a DMX packet on the DMX bus. This function blocks until the DMX
  * driver is idle and then sends a packet.
@@ -326,7 +699,8 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size);
 /**
  * @brief Sends a DMX packet on the DMX bus. This function blocks until the DMX
  * driver is idle and then sends a packet. Calling this function is the same as
- * calling dmx_send_num(dmx_num, 0).
+ * calling dmx_send_num(dmx_num, 0), unless adaptive packet length is enabled
+ * with dmx_auto_size_enable().
  *
  * @note This function uses FreeRTOS direct-to-task notifications to block and
  * unblock. Using task notifications on the same task that calls this function
@@ -337,6 +711,86 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size);
  */
 size_t dmx_send(dmx_port_t dmx_num);
 
+/**
+ * @brief Sends a DMX packet on the DMX bus without blocking. If the DMX driver
+ * is still sending the previous packet, this function returns 0 immediately
+ * instead of waiting. Otherwise the packet is sent as with dmx_send_num() and
+ * the callback is called from the DMX driver's interrupt service routine when
+ * the packet is done sending. This allows a single task to drive several DMX
+ * ports. If the minimum time between packets has not elapsed, the DMX break is
+ * started by the DMX driver's timer when it elapses instead of blocking.
+ * Packets which don't begin with a DMX break, such as RDM discovery responses,
+ * wait for the minimum time between packets before this function returns.
+ *
+ * @note The callback is called from an interrupt service routine, so it must
+ * be short and may only call FreeRTOS functions which are safe to call from an
+ * ISR. If the DMX driver is placed in IRAM, the callback must also be placed in
+ * IRAM.
+ *
+ * @param dmx_num The DMX port number.
+ * @param size The size of the packet to send. If 0, sends a full DMX packet. If
+ * an RDM packet was written, this value is ignored.
+ * @param callback The function to call when the packet is done sending. May be
+ * NULL.
+ * @param[in] context A pointer which is passed to the callback.
+ * @return The number of bytes sent on the DMX bus or 0 if the DMX driver is
+ * busy.
+ */
+size_t dmx_send_async(dmx_port_t dmx_num, size_t size, dmx_send_cb_t callback,
+                      void *context);
+
+/**
+ * @brief Enables adaptive packet length. When enabled, dmx_send() sends DMX
+ * packets only up to the highest slot that has been written since the DMX
+ * driver was installed. Shorter DMX packets can be sent at a higher rate,
+ * which lowers the latency of DMX receivers on small rigs. The start of each
+ * DMX break is spaced at least the minimum break-to-break time apart.
+ *
+ * @param dmx_num The DMX port number.
+ * @param break_to_break_us The minimum time in microseconds from the start of
+ * one DMX break to the start of the next. Values lower than
+ * DMX_BREAK_TO_BREAK_MIN_US are raised to DMX_BREAK_TO_BREAK_MIN_US.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_auto_size_enable(dmx_port_t dmx_num, uint32_t break_to_break_us);
+
+/**
+ * @brief Disables adaptive packet length. dmx_send() then sends full DMX
+ * packets.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_auto_size_disable(dmx_port_t dmx_num);
+
+/**
+ * @brief Sends a DMX packet on several DMX ports at the same time. This
+ * function blocks until each DMX driver is idle. The timer of every port is
+ * then armed to expire at the same point in time, once every port has waited
+ * the minimum time between packets, and each timer interrupt starts the DMX
+ * break of its port. This is useful when adjacent universes drive the same
+ * display. Alignment is best-effort: the ports don't share a hardware timer, so
+ * the DMX breaks are skewed by the difference in interrupt latency. The ports
+ * are locked in ascending order, regardless of the order of the array, so
+ * concurrent calls with overlapping ports don't deadlock.
+ *
+ * @note The data in each DMX driver is sent as a DMX packet. RDM packets cannot
+ * be sent with this function.
+ *
+ * @param[in] dmx_nums An array of distinct DMX port numbers.
+ * @param num The number of DMX ports in the array.
+ * @param size The size of the packets to send. If 0, sends full DMX packets.
+ * @param[out] skew_us An optional pointer which receives the time in
+ * microseconds between the start of the first and the last DMX break, as
+ * recorded by the timer interrupt of each port. If it is not NULL, this
+ * function also blocks until every packet has been sent.
+ * @return The number of bytes sent on each DMX port or 0 on failure.
+ */
+size_t dmx_send_group(const dmx_port_t *dmx_nums, size_t num, size_t size,
+                      uint32_t *skew_us);
+
 /**
  * @brief Waits until the DMX packet is done being sent. This function can be
  * used to ensure that calls to dmx_write() happen synchronously with the
@@ -353,6 +807,48 @@ size_t dmx_send(dmx_port_t dmx_num);
  */
 bool dmx_wait_sent(dmx_port_t dmx_num, TickType_t wait_ticks);
 
+/**
+ * @brief Starts sending DMX packets continuously. Each packet is started by the
+ * DMX driver's interrupt handlers as soon as the previous packet is done being
+ * sent and the packet period has elapsed, so DMX is sent at a steady rate
+ * without any task involvement. DMX data may be updated at any time using
+ * dmx_write() and its variations. Packets cannot be sent using dmx_send() while
+ * DMX is being sent continuously, which also prevents sending RDM requests.
+ * Continuous mode cannot be enabled while a fade or a merge source is active.
+ * Merge sources can be released with dmx_merge_release().
+ *
+ * @param dmx_num The DMX port number.
+ * @param size The size of the packets to send. If 0, sends full DMX packets.
+ * @param period_us The time in microseconds from the start of one packet to
+ * the start of the next. Values lower than DMX_BREAK_TO_BREAK_MIN_US are
+ * raised to DMX_BREAK_TO_BREAK_MIN_US. If the period is shorter than the time
+ * it takes to send a packet, packets are sent back-to-back. A full DMX packet
+ * sent at the default timing takes about 22.7 milliseconds, or 44 packets per
+ * second.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_continuous_enable(dmx_port_t dmx_num, size_t size, uint32_t period_us);
+
+/**
+ * @brief Stops sending DMX packets continuously. The packet which is currently
+ * being sent is finished. Use dmx_wait_sent() to wait for it to finish.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_continuous_disable(dmx_port_t dmx_num);
+
+/**
+ * @brief Checks if the DMX driver is sending DMX packets continuously.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true if DMX is being sent continuously.
+ * @return false if not.
+ */
+bool dmx_continuous_is_enabled(dmx_port_t dmx_num);
+
 #ifdef __cplusplus
 }
 #endif
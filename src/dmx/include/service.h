@@ -40,6 +40,10 @@ extern "C" {
  * to be placed within IRAM. The current hardware configuration of this device
  * places the DMX driver functions within IRAM. */
 #define DMX_ISR_ATTR IRAM_ATTR
+/** @brief This macro places constant data which is read within DMX interrupt
+ * handlers into DRAM so that it is accessible while the flash cache is
+ * disabled.*/
+#define DMX_ISR_DATA_ATTR DRAM_ATTR
 /** @brief This macro is used to conditionally compile certain parts of code
  * depending on whether or not the DMX driver is within IRAM.*/
 #define DMX_ISR_IN_IRAM
@@ -48,17 +52,35 @@ extern "C" {
  * to be placed within IRAM. Due to the current hardware configuration of this
  * device, the DMX driver is not currently placed within IRAM. */
 #define DMX_ISR_ATTR
+/** @brief This macro places constant data which is read within DMX interrupt
+ * handlers into DRAM. The DMX driver is not currently placed within IRAM so
+ * this data may remain in flash.*/
+#define DMX_ISR_DATA_ATTR
 #endif
 
 /** @brief Directs the DMX driver to use spinlocks in critical sections. This is
  * needed for devices which have multiple cores.*/
 #define DMX_USE_SPINLOCK
 #define DMX_SPINLOCK(n) (&dmx_driver[(n)]->spinlock)
-typedef spinlock_t dmx_spinlock_t;
+typedef portMUX_TYPE dmx_spinlock_t;
 #define DMX_SPINLOCK_INIT portMUX_INITIALIZER_UNLOCKED
 
+#ifndef __unreachable
+/** @brief Marks code which cannot be reached. Not every C library provides this
+ * macro in sys/cdefs.h.*/
+#define __unreachable() __builtin_unreachable()
+#endif
+
 extern const char *TAG;  // The log tagline for the library.
 
+/** @brief The size of each DMX buffer in bytes. DMX buffers are padded to a
+ * multiple of 4 bytes so that they may be compared one word at a time.*/
+#define DMX_BUFFER_SIZE ((DMX_PACKET_SIZE_MAX + 3) & ~3)
+
+/** @brief The minimum time in microseconds from arming the timers of a group of
+ * DMX ports to the shared alarm which starts their DMX breaks.*/
+#define DMX_GROUP_ALARM_LEAD_US 100
+
 enum dmx_parameter_type_t {
   DMX_PARAMETER_TYPE_NULL,
   DMX_PARAMETER_TYPE_DYNAMIC,
@@ -70,11 +92,12 @@ enum dmx_parameter_type_t {
 enum {
   DMX_HEAD_WAITING_FOR_BREAK = -1,  // The driver is awaiting a DMX break.
 
-  DMX_PROGRESS_STALE = 0,  // The packet has already been received.
-  DMX_PROGRESS_IN_BREAK,   // The packet is in the DMX break.
-  DMX_PROGRESS_IN_MAB,     // The packet is in the DMX mark-after-break.
-  DMX_PROGRESS_IN_DATA,    // Packet slot data is being sent or received.
-  DMX_PROGRESS_COMPLETE,   // The packet is complete.
+  DMX_PROGRESS_STALE = 0,   // The packet has already been received.
+  DMX_PROGRESS_IN_BREAK,    // The packet is in the DMX break.
+  DMX_PROGRESS_IN_MAB,      // The packet is in the DMX mark-after-break.
+  DMX_PROGRESS_IN_DATA,     // Packet slot data is being sent or received.
+  DMX_PROGRESS_COMPLETE,    // The packet is complete.
+  DMX_PROGRESS_IN_SPACING,  // The packet waits for the packet spacing to end.
 
   DMX_STATUS_IDLE = 0,   // The DMX driver is idle.
   DMX_STATUS_RECEIVING,  // The DMX driver is receiving data.
@@ -105,6 +128,48 @@ typedef struct dmx_device_t {
   dmx_parameter_t parameters[];  // An array of parameters associated with this device.
 } dmx_device_t;
 
+/** @brief The progress of a DMX fade when it is complete. Fade progress is
+ * stored in fixed-point with 24 fractional bits.*/
+#define DMX_FADE_ONE (1 << 24)
+
+/** @brief The state of the fade engine of a DMX driver. Fades are evaluated
+ * into the staged buffer each time a DMX packet is sent.*/
+typedef struct dmx_fade_t {
+  int64_t last_update;  // The timestamp (in microseconds since boot) at which the fades were last evaluated.
+  int start;  // The first slot which may be fading.
+  int end;  // One past the last slot which may be fading.
+  uint32_t progress[DMX_PACKET_SIZE_MAX];  // The progress of the fade of each slot, from 0 to DMX_FADE_ONE.
+  uint32_t rate[DMX_PACKET_SIZE_MAX];  // The progress of the fade of each slot per millisecond, or 0 if the slot is not fading.
+  uint8_t from[DMX_PACKET_SIZE_MAX];  // The value of each slot when its fade started.
+  uint8_t to[DMX_PACKET_SIZE_MAX];  // The target value of each slot.
+} dmx_fade_t;
+
+/** @brief The state of the merge engine of a DMX driver. Sources are merged
+ * into the staged buffer each time a DMX packet is sent.*/
+typedef struct dmx_merge_t {
+  uint8_t active;  // A bitmask of the sources which are merged.
+  uint8_t priority[DMX_MERGE_SOURCE_MAX];  // The priority of each source. Only the sources with the highest priority are merged.
+  uint32_t seq[DMX_MERGE_SOURCE_MAX];  // The value of write_count when each source was last written.
+  uint32_t write_count;  // Incremented every time a source is written.
+  uint32_t ltp[DMX_SLOT_BITMAP_LEN];  // A bitmap of the slots which are merged latest takes precedence.
+  uint32_t footprint[DMX_SLOT_BITMAP_LEN];  // A bitmap of the slots which have been written to any source. Only these slots are merged.
+  uint8_t owner[DMX_PACKET_SIZE_MAX];  // The source which most recently changed each slot.
+  uint8_t sources[DMX_MERGE_SOURCE_MAX][DMX_BUFFER_SIZE] __attribute__((aligned(4)));  // The DMX data of each source.
+} dmx_merge_t;
+
+/** @brief Buffers for packets with registered start codes, which are routed out
+ * of the DMX buffer as they are received.*/
+typedef struct dmx_router_t {
+  struct dmx_router_route_t {
+    int sc;  // The start code of the route, or -1 if the route is unused.
+    uint32_t seq;  // Incremented before and after a packet is copied into the route so that it is odd while the packet is being copied.
+    uint32_t read_seq;  // The value of seq when the route was last read.
+    size_t size;  // The size of the last packet which was routed.
+    SemaphoreHandle_t semaphore;  // Given each time a packet is routed.
+    uint8_t data[DMX_BUFFER_SIZE] __attribute__((aligned(4)));  // The last packet which was routed.
+  } routes[DMX_START_CODE_ROUTE_MAX];
+} dmx_router_t;
+
 /** @brief The DMX driver object used to handle reading and writing DMX data on
  * the UART port. It stores all the information needed to run and analyze DMX
  * and RDM.*/
@@ -114,6 +179,7 @@ typedef struct dmx_driver_t {
   rdm_uid_t uid;       // The driver's UID.
   uint32_t break_len;  // Length in microseconds of the transmitted break.
   uint32_t mab_len;  // Length in microseconds of the transmitted mark-after-break.
+  uint32_t rx_timeout_len;  // Length in microseconds from the last received slot to the UART RX timeout interrupt.
 
   bool is_enabled;  // True if the DMX driver is enabled.
   bool is_controller;  // True if the DMX driver is the controller on the DMX bus.
@@ -121,6 +187,12 @@ typedef struct dmx_driver_t {
   // Synchronization state
   SemaphoreHandle_t mux;      // The handle to the driver mutex which allows multi-threaded driver function calls.
   TaskHandle_t task_waiting;  // The handle to a task that is waiting for data to be sent or received.
+  struct dmx_driver_subscriber_t {
+    SemaphoreHandle_t semaphore;  // Given by the DMX driver each time a DMX packet is received, or NULL if the subscriber is unused.
+    uint32_t sequence;  // The sequence number of the last DMX packet that the subscriber was woken for.
+    bool is_closed;  // True if the subscriber was unsubscribed while a task was using its semaphore.
+    int users;  // The number of tasks which are using the semaphore. The last user deletes the semaphore of a closed subscriber.
+  } subscribers[DMX_SUBSCRIBER_MAX];  // Tasks which are woken for every DMX packet which is received without errors.
 #ifdef DMX_USE_SPINLOCK
   dmx_spinlock_t spinlock;  // The spinlock used for critical sections.
 #endif
@@ -128,12 +200,68 @@ typedef struct dmx_driver_t {
   // Data buffer
   struct dmx_driver_dmx_t {
     int head;  // The index of the slot being transmitted or received.
-    uint8_t data[DMX_PACKET_SIZE_MAX];  // The buffer that stores the DMX packet.
+    uint8_t *data;  // The buffer that stores the DMX packet. Points to one of the DMX buffers.
+    uint8_t buffers[3][DMX_BUFFER_SIZE] __attribute__((aligned(4)));  // The DMX buffers. They are used to send and receive, to stage written DMX data, and to lease complete DMX frames to the user.
+    struct dmx_driver_staged_t {
+      uint8_t *data;  // The buffer into which DMX data is written. Is never the same buffer as the DMX buffer.
+      SemaphoreHandle_t mux;  // The mutex which is held while the staged buffer is written or published.
+      bool is_locked;  // True while a task holds the mutex. The ISR doesn't swap in the staged buffer while it is locked.
+      bool is_pending;  // True if the staged buffer holds DMX data which has not been published to the DMX buffer.
+      bool is_stale;  // True if the slots of the staged buffer which haven't been written must be synchronized with the DMX buffer before it is written.
+      int dirty_start;  // The first slot which was written since the staged buffer was last published.
+      int dirty_end;  // One past the last slot which was written since the staged buffer was last published. No slot was written if it is not greater than dirty_start.
+      int size;  // One past the highest slot that has been written since the DMX driver was installed.
+    } staged;
+    struct dmx_driver_frame_t {
+      const uint8_t *data;  // The DMX buffer which holds the last complete DMX frame, or NULL if no frame has been received.
+      size_t size;  // The size of the last complete DMX frame.
+      uint32_t sequence;  // The packet sequence number of the last complete DMX frame.
+      int64_t break_timestamp;  // The timestamp (in microseconds since boot) of the DMX break of the last complete DMX frame.
+      int64_t eop_timestamp;  // The timestamp (in microseconds since boot) of the end-of-packet of the last complete DMX frame.
+      int leases;  // The number of leases on the last complete DMX frame. The frame is not replaced while it is leased.
+    } frame;
+    uint32_t sequence;  // Incremented for every DMX packet which is received without errors, whether or not it is published as a frame.
+    uint32_t last_frame[DMX_BUFFER_SIZE / 4];  // A copy of the previous complete DMX frame which is used to find changed slots.
+    uint32_t changed_slots[DMX_SLOT_BITMAP_LEN];  // A bitmap of the slots which changed since the bitmap was last read.
+    struct dmx_driver_continuous_t {
+      bool is_enabled;  // True if the DMX driver is sending DMX packets continuously.
+      int size;  // The size of the DMX packets that are sent continuously.
+      uint32_t period;  // The time in microseconds from the start of one DMX break to the start of the next.
+    } continuous;  // Continuous transmit configuration.
+    struct dmx_driver_auto_size_t {
+      bool is_enabled;  // True if dmx_send() sends DMX packets up to the highest slot that was written.
+      uint32_t break_to_break;  // The minimum time in microseconds from the start of one DMX break to the start of the next.
+    } auto_size;  // Adaptive packet length configuration.
+    struct dmx_driver_send_cb_t {
+      dmx_send_cb_t callback;  // Called when the packet that is being sent is done sending, or NULL if there is no callback. It is cleared before it is called.
+      void *context;  // The context pointer which is passed to the callback.
+    } send_cb;  // The completion callback of the packet sent with dmx_send_async().
+    SemaphoreHandle_t fade_mux;  // The mutex which is held while a task modifies or evaluates the fades.
+    SemaphoreHandle_t merge_mux;  // The mutex which is held while a task modifies or evaluates the merge.
+    dmx_fade_t *fade;  // The fade engine, or NULL if no fade has been started.
+    dmx_merge_t *merge;  // The merge engine, or NULL if it has not been used.
+    dmx_router_t *router;  // The start code router, or NULL if no start code has been registered.
+    struct dmx_driver_patch_t {
+      bool is_enabled;  // True if written DMX data is remapped with the patch table.
+      uint16_t *table;  // The physical slot of each logical slot, or 0 if the logical slot is not patched. Is NULL if no slot has been patched.
+    } patch;  // Remaps logical slots to physical slots when DMX data is written.
+    struct dmx_driver_window_t {
+      int size;  // The number of slots after which the waiting task is notified before the packet is complete, or 0 if the waiting task is only notified when the packet is complete.
+      bool is_notified;  // True if the waiting task has already been notified of the packet that is being received.
+    } window;  // Early notification configuration used by dmx_receive_footprint().
     int size;  // The expected size of the incoming/outgoing packet.
     int status;  // The status of the DMX port.
     int progress;  // The progress of the current packet.
+    uint32_t generation;  // Incremented every time the contents of the buffer change. Used to invalidate the cached RDM header.
+    uint16_t checksum;  // The running RDM checksum of the first checksum_len slots of the buffer.
+    int checksum_len;  // The number of slots which are included in the running RDM checksum.
     rdm_pid_t last_controller_pid;  // The PID of the last controller-generated packet.
+    int64_t break_timestamp;  // The timestamp (in microseconds since boot) of the start of the last controller-generated DMX break.
     int64_t controller_eop_timestamp;  // The timestamp (in microseconds since boot) of the end-of-packet of the last controller-generated packet.
+    int64_t rx_break_timestamp;  // The timestamp (in microseconds since boot) at which the DMX break of the packet being received was detected, or -1 if the packet has no DMX break.
+    int64_t rx_eop_timestamp;  // The timestamp (in microseconds since boot) at which the last slot of the packet being received arrived. Is taken from the UART RX FIFO full or timeout event which read the slot.
+    int64_t last_rx_break_timestamp;  // The value of rx_break_timestamp when the last received packet was completed.
+    int64_t last_rx_eop_timestamp;  // The timestamp (in microseconds since boot) at which the last received packet was completed.
     rdm_pid_t last_responder_pid;  // The PID of the last responder-generated packet.
     bool responder_sent_last;  // True if the last packet was a responder-generated packet.
     union {
@@ -151,7 +279,26 @@ typedef struct dmx_driver_t {
       uint8_t tn;  // The current RDM transaction number. Is incremented with every RDM request sent.
       bool boot_loader;  // The RDM responder boot-loader flag. True when when the device is incapable of normal operation until receiving a firmware upload.
     };
+    struct dmx_driver_rdm_format_t {
+      const char *string;   // The format string, or NULL if the entry is empty.
+      rdm_format_t format;  // The compiled format string.
+    } formats[RDM_FORMAT_CACHE_SIZE];  // Compiled RDM format strings, indexed by a hash of the format string pointer.
+    struct dmx_driver_rdm_header_cache_t {
+      uint32_t generation;  // The generation of the DMX buffer from which the header was decoded.
+      bool is_valid;  // True if the DMX buffer contained a valid RDM packet.
+      rdm_header_t header;  // The decoded RDM header.
+    } header_cache;  // The RDM header of the packet in the DMX buffer.
+    uint8_t *dmx_data;  // The DMX buffer while an RDM request is sent from the RDM buffer, or NULL if the RDM buffer is not in use.
+    uint8_t buffer[DMX_BUFFER_SIZE] __attribute__((aligned(4)));  // The RDM buffer. RDM requests are sent and their responses are received in this buffer so that the DMX data in the DMX buffer is not overwritten.
   } rdm;
+
+  // Receive statistics
+  struct dmx_driver_stats_t {
+    uint32_t seq;  // Incremented before and after the statistics are updated so that it is odd while they are being updated. The statistics are only updated by the UART ISR.
+    int64_t last_packet_timestamp;  // The timestamp (in microseconds since boot) of the DMX break of the last DMX packet with a null start code, or -1 if none has been received.
+    bool is_rdm_invalid;  // True if the packet being received is an RDM packet with an invalid checksum.
+    dmx_stats_t values;  // The receive statistics.
+  } stats;
   
   // DMX sniffer configuration
   struct dmx_driver_sniffer_t {
@@ -215,6 +362,65 @@ dmx_parameter_t *dmx_parameter_get_entry(dmx_port_t dmx_num,
                                          dmx_device_num_t device_num,
                                          rdm_pid_t pid);
 
+/**
+ * @brief Gets the DMX buffer which is neither the DMX buffer nor the staged
+ * buffer.
+ *
+ * @param driver A pointer to the DMX driver.
+ * @return A pointer to the spare DMX buffer.
+ */
+static inline uint8_t *dmx_buffer_get_spare(dmx_driver_t *driver) {
+  for (int i = 0; i < 2; ++i) {
+    if (driver->dmx.buffers[i] != driver->dmx.data &&
+        driver->dmx.buffers[i] != driver->dmx.staged.data) {
+      return driver->dmx.buffers[i];
+    }
+  }
+  return driver->dmx.buffers[2];
+}
+
+/**
+ * @brief Ensures that the DMX buffer may be overwritten without modifying the
+ * last complete DMX frame. If the DMX buffer holds the last complete DMX frame,
+ * the spare DMX buffer becomes the DMX buffer. The contents of the DMX buffer
+ * are not copied. This function must be called within a critical section.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_buffer_detach_frame(dmx_port_t dmx_num);
+
+/**
+ * @brief Sends and receives packets in the RDM buffer instead of the DMX
+ * buffer. The DMX buffer is not copied and is left untouched until
+ * dmx_buffer_detach_rdm() is called. The RDM buffer can't be used while DMX is
+ * sent continuously because the ISR swaps the DMX buffer with the staged
+ * buffer. The DMX driver mutex must be taken and the driver must be done
+ * sending.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true if the RDM buffer is in use.
+ * @return false if DMX is sent continuously.
+ */
+bool dmx_buffer_attach_rdm(dmx_port_t dmx_num);
+
+/**
+ * @brief Stops sending and receiving packets in the RDM buffer and restores the
+ * DMX buffer. Does nothing if the RDM buffer is not in use. The DMX driver
+ * mutex must be taken and the driver must be done sending.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_buffer_detach_rdm(dmx_port_t dmx_num);
+
+/**
+ * @brief Merges the sources of the merge engine into the staged buffer. Only
+ * the slots which have been written to a source are merged. Does nothing if no
+ * source is merged. This is called each time a DMX packet is sent.
+ *
+ * @param dmx_num The DMX port number.
+ */
+void dmx_merge_update(dmx_port_t dmx_num);
+
 #ifdef __cplusplus
 }
 #endif
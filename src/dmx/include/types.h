@@ -70,7 +70,7 @@ extern "C" {
 enum {
   DMX_NUM_0, /** @brief DMX port 0.*/
   DMX_NUM_1, /** @brief DMX port 1.*/
-#if SOC_UART_NUM > 2
+#if SOC_UART_NUM > 2 || defined(CONFIG_IDF_TARGET_LINUX)
   DMX_NUM_2, /** @brief DMX port 2.*/
 #endif
   DMX_NUM_MAX /** @brief DMX port max. Used for error checking.*/
@@ -83,6 +83,50 @@ enum {
   DMX_PIN_NO_CHANGE = -1
 };
 
+/** @brief DMX merge constants.*/
+enum {
+  /** @brief Highest takes precedence. The slot is set to the highest value of
+     the merged sources.*/
+  DMX_MERGE_HTP = 0,
+  /** @brief Latest takes precedence. The slot is set to the value of the
+     source which changed it most recently.*/
+  DMX_MERGE_LTP = 1,
+
+  /** @brief The number of sources which may be merged into each DMX port.*/
+  DMX_MERGE_SOURCE_MAX = 4
+};
+
+/** @brief DMX receive statistics constants.*/
+enum {
+  /** @brief The number of bins in the packet interval histogram. Bin 0 counts
+     intervals shorter than 1024 microseconds. Bin N counts intervals of at
+     least 512 << N microseconds and shorter than 1024 << N microseconds. The
+     last bin also counts all longer intervals.*/
+  DMX_STATS_INTERVAL_BINS = 10,
+  /** @brief The number of bins in the packet size histogram. Bin 0 counts
+     packets with fewer than 32 slots, not including the start code. Bin N
+     counts packets with at least 16 << N slots and fewer than 32 << N slots.
+     The last bin counts full 512-slot packets.*/
+  DMX_STATS_SIZE_BINS = 6,
+  /** @brief The number of error counters. There is one counter for each
+     dmx_err_t value other than DMX_FAIL, indexed by the error code.*/
+  DMX_STATS_ERR_MAX = 5
+};
+
+/** @brief DMX frame subscriber constants.*/
+enum {
+  /** @brief The maximum number of tasks which may subscribe to the DMX frames
+     of each DMX port.*/
+  DMX_SUBSCRIBER_MAX = 8
+};
+
+/** @brief DMX start code routing constants.*/
+enum {
+  /** @brief The maximum number of start codes which may be registered with
+     dmx_start_code_register() on each DMX port.*/
+  DMX_START_CODE_ROUTE_MAX = 4
+};
+
 /** @brief DMX requirements constants. These constants are simplified
  * significantly to ensure ease of use for the end user. When used with this
  * library, these constants will ensure that library settings are always within
@@ -93,6 +137,10 @@ enum {
   DMX_PACKET_SIZE = 513,
   /** @brief The maximum packet size of DMX.*/
   DMX_PACKET_SIZE_MAX = 513,
+  /** @brief The number of 32-bit words in a bitmap of DMX slots. Bit N of the
+     bitmap, counting from the least significant bit of the first word,
+     corresponds to slot N.*/
+  DMX_SLOT_BITMAP_LEN = (DMX_PACKET_SIZE_MAX + 31) / 32,
 
   /** @brief The typical baud rate of DMX.*/
   DMX_BAUD_RATE = 250000,
@@ -115,6 +163,13 @@ enum {
   /** @brief The maximum DMX mark-after-break length in microseconds.*/
   DMX_MAB_LEN_MAX_US = 999999,
 
+  /** @brief The minimum time in microseconds from the start of one DMX break
+     to the start of the next.*/
+  DMX_BREAK_TO_BREAK_MIN_US = 1204,
+  /** @brief The minimum size of DMX packets which are sent with adaptive
+     packet length. This is the start code and one slot.*/
+  DMX_PACKET_SIZE_AUTO_MIN = 2,
+
   /** @brief The DMX receive timeout length in FreeRTOS ticks. If it takes
      longer than this amount of time to receive the next DMX packet the signal
      is considered lost.*/
@@ -247,6 +302,14 @@ typedef unsigned int dmx_port_t;
 /** @brief DMX device number type.*/
 typedef uint16_t dmx_device_num_t;
 
+/** @brief The function type for callbacks which are called from the DMX
+ * driver's interrupt service routine when a packet sent with dmx_send_async()
+ * is done sending. The callback receives the DMX port number, the size of the
+ * packet that was sent, and the context pointer that was passed to
+ * dmx_send_async(). It must return true if it woke a task with a higher
+ * priority than the interrupted task, such as by calling xQueueSendFromISR().*/
+typedef bool (*dmx_send_cb_t)(dmx_port_t dmx_num, size_t size, void *context);
+
 /** @brief Type which indicates errors, or lack thereof, for DMX operations.*/
 typedef enum dmx_err_t {
   /** @brief DMX error value indicating no error.*/
@@ -263,6 +326,10 @@ typedef enum dmx_err_t {
   DMX_FAIL = -1
 } dmx_err_t;
 
+/** @brief A DMX Hardware Abstraction Layer (HAL) backend. This type is
+ * defined in dmx/hal/include/hal.h.*/
+typedef struct dmx_hal_t dmx_hal_t;
+
 /** @brief Configuration settings for the DMX driver.*/
 typedef struct dmx_config_t {
   /** @brief The interrupt allocation flags to use.*/
@@ -288,6 +355,9 @@ typedef struct dmx_config_t {
   /** @brief The maximum size of the RDM queue. Setting this value to 0 disables
    * the RDM queue.*/
   uint32_t queue_size_max;
+  /** @brief The HAL backend which drives the DMX port. Setting this value to
+   * NULL uses the UART, timer, and GPIO peripherals of this target.*/
+  const dmx_hal_t *hal;
 } dmx_config_t;
 
 /** @brief A struct which defines DMX personalities. Used to declare the
@@ -311,8 +381,83 @@ typedef struct dmx_packet_t {
   size_t size;
   /** @brief True if the received packet is RDM.*/
   bool is_rdm;
+  /** @brief The timestamp, in microseconds since boot, at which the DMX driver
+     detected the DMX break of the packet, or -1 if no packet was received or
+     the packet had no DMX break.*/
+  int64_t break_timestamp;
+  /** @brief The timestamp, in microseconds since boot, at which the DMX driver
+     received the last slot of the packet, or -1 if no packet was received. If
+     the packet was smaller than expected, this is the timestamp at which the
+     DMX break of the following packet was detected.*/
+  int64_t eop_timestamp;
 } dmx_packet_t;
 
+/** @brief A complete DMX frame which is leased to the user with
+ * dmx_frame_acquire(). The frame is not modified by the DMX driver until it is
+ * released with dmx_frame_release().*/
+typedef struct dmx_frame_t {
+  /** @brief A pointer to the slots of the DMX frame, beginning with the start
+     code.*/
+  const uint8_t *data;
+  /** @brief The size of the DMX frame in slots, including the start code.*/
+  size_t size;
+  /** @brief The sequence number of the DMX frame. Is incremented with every
+     DMX packet received without errors by the DMX driver, including packets
+     which were not published as frames.*/
+  uint32_t sequence;
+  /** @brief The timestamp, in microseconds since boot, at which the DMX driver
+     detected the DMX break of the frame.*/
+  int64_t break_timestamp;
+  /** @brief The timestamp, in microseconds since boot, at which the DMX driver
+     received the last slot of the frame.*/
+  int64_t eop_timestamp;
+} dmx_frame_t;
+
+/** @brief A single contiguous range of slots which is written with
+ * dmx_write_scatter().*/
+typedef struct dmx_iovec_t {
+  /** @brief The slot number at which to begin writing.*/
+  size_t offset;
+  /** @brief A pointer to the source buffer which is copied to the DMX
+     driver.*/
+  const void *source;
+  /** @brief The size of the source buffer.*/
+  size_t size;
+} dmx_iovec_t;
+
+/** @brief Statistics of the packets which have been received by the DMX
+ * driver. Counters begin at zero when the DMX driver is installed and are never
+ * reset, so rates may be found by comparing two snapshots.*/
+typedef struct dmx_stats_t {
+  /** @brief The number of DMX packets with a null start code which were
+     received without error.*/
+  uint32_t packet_count;
+  /** @brief The refresh rate in packets per second of DMX packets with a null
+     start code, or 0 if no such packet was received within the DMX receive
+     timeout.*/
+  uint32_t refresh_rate;
+  /** @brief The moving average in microseconds of the time from the start of
+     one DMX break to the start of the next.*/
+  uint32_t interval;
+  /** @brief The moving average in microseconds of the deviation of each packet
+     interval from the average packet interval.*/
+  uint32_t jitter;
+  /** @brief A histogram of packet intervals. See DMX_STATS_INTERVAL_BINS.*/
+  uint32_t interval_histogram[DMX_STATS_INTERVAL_BINS];
+  /** @brief A histogram of packet sizes. See DMX_STATS_SIZE_BINS.*/
+  uint32_t size_histogram[DMX_STATS_SIZE_BINS];
+  /** @brief The number of packets which completed with each dmx_err_t code.
+     UART overflows are counted in err_count[DMX_ERR_UART_OVERFLOW]. Timeouts
+     are detected by the receiving task rather than the DMX driver and are not
+     counted.*/
+  uint32_t err_count[DMX_STATS_ERR_MAX];
+  /** @brief The number of RDM packets which were discarded because their
+     checksum was invalid.*/
+  uint32_t rdm_checksum_errors;
+  /** @brief The number of packets received with each start code.*/
+  uint32_t start_codes[256];
+} dmx_stats_t;
+
 /** @brief Metadata for received DMX packets. For use in the DMX sniffer.*/
 typedef struct dmx_metadata_t {
   /** @brief Length in microseconds of the last received DMX break.*/
@@ -1,16 +1,180 @@
+#include <limits.h>
 #include <string.h>
 
 #include "dmx/hal/include/gpio.h"
 #include "dmx/hal/include/nvs.h"
 #include "dmx/hal/include/timer.h"
 #include "dmx/hal/include/uart.h"
+#include "dmx/include/device.h"
 #include "dmx/include/driver.h"
 #include "dmx/include/parameter.h"
 #include "dmx/include/service.h"
+#include "dmx/trace.h"
 #include "rdm/include/driver.h"
 #include "rdm/include/uid.h"
 #include "rdm/responder/include/utils.h"
 
+static void dmx_staged_sync(dmx_driver_t *driver, const uint8_t *data) {
+  // Copy the slots which have not been written since the last publish
+  uint8_t *const staged = driver->dmx.staged.data;
+  const int start = driver->dmx.staged.dirty_start;
+  const int end = driver->dmx.staged.dirty_end;
+  if (start >= end) {
+    memcpy(staged, data, DMX_BUFFER_SIZE);
+  } else {
+    memcpy(staged, data, start);
+    memcpy(staged + end, data + end, DMX_BUFFER_SIZE - end);
+  }
+}
+
+static void dmx_staged_begin_write(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Block until no other task is writing or publishing the staged buffer
+  xSemaphoreTake(driver->dmx.staged.mux, portMAX_DELAY);
+  bool needs_sync;
+  const uint8_t *data;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.staged.is_locked = true;
+  needs_sync = driver->dmx.staged.is_stale;
+  driver->dmx.staged.is_stale = false;
+  data = driver->rdm.dmx_data != NULL ? driver->rdm.dmx_data : driver->dmx.data;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  /* The staged buffer is stale after it was swapped with the DMX buffer by the
+  ISR. The DMX buffer is only read while DMX is sent and it can't be swapped
+  while the staged buffer is locked, so it is safe to copy it.*/
+  if (needs_sync) {
+    dmx_staged_sync(driver, data);
+  }
+}
+
+static void dmx_staged_end_write(dmx_port_t dmx_num, bool is_pending) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.staged.is_locked = false;
+  if (is_pending) {
+    driver->dmx.staged.is_pending = true;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  xSemaphoreGive(driver->dmx.staged.mux);
+}
+
+static void dmx_staged_extend(dmx_driver_t *driver, int end) {
+  // Record the highest slot which has been written for adaptive packet length
+  taskENTER_CRITICAL(DMX_SPINLOCK(driver->dmx_num));
+  if (end > driver->dmx.staged.size) {
+    driver->dmx.staged.size = end;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(driver->dmx_num));
+}
+
+static void dmx_staged_mark(dmx_driver_t *driver, int start, int end) {
+  // Record the written slots, which are published to the DMX buffer
+  taskENTER_CRITICAL(DMX_SPINLOCK(driver->dmx_num));
+  if (driver->dmx.staged.dirty_start >= driver->dmx.staged.dirty_end) {
+    driver->dmx.staged.dirty_start = start;
+    driver->dmx.staged.dirty_end = end;
+  } else {
+    if (start < driver->dmx.staged.dirty_start) {
+      driver->dmx.staged.dirty_start = start;
+    }
+    if (end > driver->dmx.staged.dirty_end) {
+      driver->dmx.staged.dirty_end = end;
+    }
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(driver->dmx_num));
+}
+
+static void dmx_staged_publish(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Nothing is published while an RDM request is sent from the RDM buffer
+  bool is_pending;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  is_pending = driver->dmx.staged.is_pending && driver->rdm.dmx_data == NULL;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (!is_pending) {
+    return;
+  }
+
+  /* Block until the staged buffer isn't being written. Only the written slots
+  are copied so that the rest of the DMX buffer is sent unchanged. The last
+  complete DMX frame can't be modified, so it is copied to the spare buffer.*/
+  xSemaphoreTake(driver->dmx.staged.mux, portMAX_DELAY);
+  const uint8_t *frame = NULL;
+  int start;
+  int end;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (driver->dmx.data == driver->dmx.frame.data) {
+    frame = driver->dmx.frame.data;
+    dmx_buffer_detach_frame(dmx_num);
+  }
+  start = driver->dmx.staged.dirty_start;
+  end = driver->dmx.staged.dirty_end;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (frame != NULL) {
+    memcpy(driver->dmx.data, frame, DMX_BUFFER_SIZE);
+  }
+  if (start < end) {
+    memcpy(driver->dmx.data + start, driver->dmx.staged.data + start,
+           end - start);
+  }
+
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.staged.is_pending = false;
+  driver->dmx.staged.dirty_start = 0;
+  driver->dmx.staged.dirty_end = 0;
+  driver->dmx.checksum_len = 0;
+  ++driver->dmx.generation;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  xSemaphoreGive(driver->dmx.staged.mux);
+}
+
+static inline int dmx_patch_get(const dmx_driver_t *driver, int slot_num) {
+  // The start code is never patched
+  if (!driver->dmx.patch.is_enabled || slot_num == 0) {
+    return slot_num;
+  }
+  const int physical = driver->dmx.patch.table[slot_num];
+  return physical != 0 ? physical : -1;
+}
+
+static int dmx_patch_copy(dmx_driver_t *driver, uint8_t *destination,
+                          size_t offset, const uint8_t *source, size_t size,
+                          int *start) {
+  if (!driver->dmx.patch.is_enabled) {
+    memcpy(destination + offset, source, size);
+    *start = offset;
+    return offset + size;
+  }
+
+  // Copy each logical slot to its physical slot, dropping unpatched slots
+  *start = DMX_PACKET_SIZE_MAX;
+  int end = 0;
+  for (int i = 0; i < size; ++i) {
+    const int slot_num = dmx_patch_get(driver, offset + i);
+    if (slot_num >= 0) {
+      destination[slot_num] = source[i];
+      *start = slot_num < *start ? slot_num : *start;
+      end = slot_num + 1 > end ? slot_num + 1 : end;
+    }
+  }
+  return end;
+}
+
+static void dmx_staged_copy(dmx_driver_t *driver, size_t offset,
+                            const uint8_t *source, size_t size) {
+  int start;
+  const int end = dmx_patch_copy(driver, driver->dmx.staged.data, offset,
+                                 source, size, &start);
+  if (start < end) {
+    dmx_staged_mark(driver, start, end);
+    dmx_staged_extend(driver, end);
+  }
+}
+
 size_t dmx_read_offset(dmx_port_t dmx_num, size_t offset, void *destination,
                        size_t size) {
   DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
@@ -21,40 +185,835 @@ size_t dmx_read_offset(dmx_port_t dmx_num, size_t offset, void *destination,
   // Clamp size to the maximum DMX packet size
   if (size + offset > DMX_PACKET_SIZE_MAX) {
     size = DMX_PACKET_SIZE_MAX - offset;
-  } else if (size == 0) {
-    return 0;
+  } else if (size == 0) {
+    return 0;
+  }
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  /* Read DMX data that was written but not yet sent from the staged buffer. A
+  receiving port reads the last complete DMX frame, which is leased during the
+  copy so that the DMX driver doesn't receive the next packet into it. If every
+  requested slot of the DMX packet being received has already arrived, such as
+  after dmx_receive_footprint() returns, the slots are read from that packet
+  instead. That copy is retried if the next DMX break arrives during it, so the
+  slots of two packets are never mixed.*/
+  int dirty_start = 0;
+  int dirty_end = 0;
+  while (true) {
+    const uint8_t *data;
+    bool is_leased = false;
+    int64_t break_timestamp = -1;
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (driver->dmx.staged.is_pending) {
+      data = driver->rdm.dmx_data != NULL ? driver->rdm.dmx_data
+                                          : driver->dmx.data;
+      dirty_start = driver->dmx.staged.dirty_start;
+      dirty_end = driver->dmx.staged.dirty_end;
+    } else if (driver->is_controller) {
+      data = driver->dmx.data;
+    } else if (driver->dmx.status == DMX_STATUS_RECEIVING &&
+               driver->dmx.rx_break_timestamp >= 0 &&
+               driver->dmx.head >= (int)(offset + size) &&
+               driver->dmx.data[0] == DMX_SC) {
+      data = driver->dmx.data;
+      break_timestamp = driver->dmx.rx_break_timestamp;
+    } else if (driver->dmx.frame.data != NULL) {
+      data = driver->dmx.frame.data;
+      ++driver->dmx.frame.leases;
+      is_leased = true;
+    } else {
+      data = driver->dmx.data;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+    // Copy data from the driver buffer to the destination asynchronously
+    memcpy(destination, data + offset, size);
+
+    bool is_torn = false;
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (is_leased) {
+      --driver->dmx.frame.leases;
+    } else if (break_timestamp >= 0) {
+      is_torn = driver->dmx.rx_break_timestamp != break_timestamp;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (!is_torn) {
+      break;
+    }
+  }
+
+  // Overlay the slots which were written but not yet sent
+  const int first = offset;
+  const int last = offset + size;
+  const int start = dirty_start > first ? dirty_start : first;
+  const int end = dirty_end < last ? dirty_end : last;
+  if (start < end) {
+    memcpy((uint8_t *)destination + (start - first),
+           driver->dmx.staged.data + start, end - start);
+  }
+
+  return size;
+}
+
+size_t dmx_read(dmx_port_t dmx_num, void *destination, size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(destination, 0, "destination is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+
+  return dmx_read_offset(dmx_num, 0, destination, size);
+}
+
+int dmx_read_slot(dmx_port_t dmx_num, size_t slot_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, -1, "dmx_num error");
+  DMX_CHECK(slot_num < DMX_PACKET_SIZE_MAX, -1, "slot_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), -1, "driver is not installed");
+
+  uint8_t slot;
+  dmx_read_offset(dmx_num, slot_num, &slot, 1);
+
+  return slot;
+}
+
+bool dmx_frame_acquire(dmx_port_t dmx_num, dmx_frame_t *frame) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(frame, false, "frame is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  bool is_leased;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  is_leased = driver->dmx.frame.data != NULL;
+  if (is_leased) {
+    ++driver->dmx.frame.leases;
+    frame->data = driver->dmx.frame.data;
+    frame->size = driver->dmx.frame.size;
+    frame->sequence = driver->dmx.frame.sequence;
+    frame->break_timestamp = driver->dmx.frame.break_timestamp;
+    frame->eop_timestamp = driver->dmx.frame.eop_timestamp;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return is_leased;
+}
+
+bool dmx_frame_release(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  bool was_leased;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  was_leased = driver->dmx.frame.leases > 0;
+  if (was_leased) {
+    --driver->dmx.frame.leases;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_CHECK(was_leased, false, "frame is not leased");
+
+  return true;
+}
+
+int dmx_frame_subscribe(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, -1, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), -1, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  SemaphoreHandle_t semaphore = xSemaphoreCreateBinary();
+  DMX_CHECK(semaphore != NULL, -1, "subscriber malloc error");
+
+  // Claim an unused subscriber, starting from the newest frame
+  int subscriber = -1;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  for (int i = 0; i < DMX_SUBSCRIBER_MAX; ++i) {
+    if (driver->subscribers[i].semaphore == NULL) {
+      driver->subscribers[i].semaphore = semaphore;
+      driver->subscribers[i].sequence = driver->dmx.sequence;
+      driver->subscribers[i].is_closed = false;
+      driver->subscribers[i].users = 0;
+      subscriber = i;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (subscriber < 0) {
+    vSemaphoreDelete(semaphore);
+  }
+  DMX_CHECK(subscriber >= 0, -1, "no subscribers are available");
+
+  return subscriber;
+}
+
+static void dmx_subscriber_release(dmx_port_t dmx_num, int subscriber,
+                                   SemaphoreHandle_t semaphore) {
+  struct dmx_driver_subscriber_t *const sub =
+      &dmx_driver[dmx_num]->subscribers[subscriber];
+
+  // The last task to use the semaphore of a closed subscriber deletes it
+  bool is_deleted = false;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  --sub->users;
+  if (sub->is_closed && sub->users == 0) {
+    sub->semaphore = NULL;
+    sub->is_closed = false;
+    is_deleted = true;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (is_deleted) {
+    vSemaphoreDelete(semaphore);
+  }
+}
+
+bool dmx_frame_unsubscribe(dmx_port_t dmx_num, int subscriber) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(subscriber >= 0 && subscriber < DMX_SUBSCRIBER_MAX, false,
+            "subscriber error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  struct dmx_driver_subscriber_t *const sub = &driver->subscribers[subscriber];
+
+  // Close the subscriber so that a task which is waiting returns false
+  SemaphoreHandle_t semaphore;
+  bool is_subscribed;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  semaphore = sub->semaphore;
+  is_subscribed = semaphore != NULL && !sub->is_closed;
+  if (is_subscribed) {
+    sub->is_closed = true;
+    ++sub->users;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_CHECK(is_subscribed, false, "subscriber is not subscribed");
+  xSemaphoreGive(semaphore);
+
+  dmx_subscriber_release(dmx_num, subscriber, semaphore);
+
+  return true;
+}
+
+bool dmx_frame_wait(dmx_port_t dmx_num, int subscriber, uint32_t *sequence,
+                    TickType_t wait_ticks) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(subscriber >= 0 && subscriber < DMX_SUBSCRIBER_MAX, false,
+            "subscriber error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  struct dmx_driver_subscriber_t *const sub = &driver->subscribers[subscriber];
+
+  // Use the semaphore so that it isn't deleted by dmx_frame_unsubscribe()
+  SemaphoreHandle_t semaphore;
+  bool is_subscribed;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  semaphore = sub->semaphore;
+  is_subscribed = semaphore != NULL && !sub->is_closed;
+  if (is_subscribed) {
+    ++sub->users;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_CHECK(is_subscribed, false, "subscriber is not subscribed");
+
+  // The semaphore may have been given for a packet that was already seen
+  TimeOut_t timeout;
+  vTaskSetTimeOutState(&timeout);
+  bool is_new;
+  uint32_t packet_sequence;
+  while (true) {
+    bool is_closed;
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    packet_sequence = driver->dmx.sequence;
+    is_closed = sub->is_closed;
+    is_new = !is_closed && packet_sequence != sub->sequence;
+    if (is_new) {
+      sub->sequence = packet_sequence;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (is_new || is_closed || xTaskCheckForTimeOut(&timeout, &wait_ticks) ||
+        !xSemaphoreTake(semaphore, wait_ticks)) {
+      break;
+    }
+  }
+  dmx_subscriber_release(dmx_num, subscriber, semaphore);
+
+  if (is_new && sequence != NULL) {
+    *sequence = packet_sequence;
+  }
+  return is_new;
+}
+
+bool dmx_read_changed_slots(dmx_port_t dmx_num, uint32_t *bitmap) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(bitmap, false, "bitmap is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Copy and clear the bitmap
+  uint32_t any_changed = 0;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  for (int i = 0; i < DMX_SLOT_BITMAP_LEN; ++i) {
+    bitmap[i] = driver->dmx.changed_slots[i];
+    driver->dmx.changed_slots[i] = 0;
+    any_changed |= bitmap[i];
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return any_changed != 0;
+}
+
+int dmx_find_changed_slots(const uint32_t *bitmap, size_t slot_num,
+                           size_t *size) {
+  DMX_CHECK(bitmap, -1, "bitmap is null");
+  DMX_CHECK(size, -1, "size is null");
+
+  // Find the first changed slot, skipping words with no changed slots
+  int i = slot_num / 32;
+  uint32_t word = i < DMX_SLOT_BITMAP_LEN ? bitmap[i] & (~0u << (slot_num % 32))
+                                          : 0;
+  while (word == 0) {
+    if (++i >= DMX_SLOT_BITMAP_LEN) {
+      *size = 0;
+      return -1;  // No more slots changed
+    }
+    word = bitmap[i];
+  }
+  const int start = i * 32 + __builtin_ctz(word);
+
+  // Find the end of the range of changed slots
+  word = ~bitmap[i] & (~0u << (start % 32));
+  while (word == 0 && ++i < DMX_SLOT_BITMAP_LEN) {
+    word = ~bitmap[i];
+  }
+  int end = word != 0 ? i * 32 + __builtin_ctz(word) : i * 32;
+  if (end > DMX_PACKET_SIZE_MAX) {
+    end = DMX_PACKET_SIZE_MAX;
+  }
+  *size = end - start;
+
+  return start;
+}
+
+size_t dmx_write_offset(dmx_port_t dmx_num, size_t offset, const void *source,
+                        size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(offset < DMX_PACKET_SIZE_MAX, 0, "offset error");
+  DMX_CHECK(source, 0, "source is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+
+  // Clamp size to the maximum DMX packet size
+  if (size + offset > DMX_PACKET_SIZE_MAX) {
+    size = DMX_PACKET_SIZE_MAX - offset;
+  } else if (size == 0) {
+    return 0;
+  }
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Flip the DMX bus to write mode
+  if (dmx_uart_get_rts(dmx_num) == 1) {
+    dmx_uart_set_rts(dmx_num, 0);
+  }
+
+  // Copy data from the source to the staged buffer without a critical section
+  dmx_staged_begin_write(dmx_num);
+  dmx_staged_copy(driver, offset, source, size);
+  dmx_staged_end_write(dmx_num, true);
+
+  return size;
+}
+
+bool dmx_buffer_attach_rdm(dmx_port_t dmx_num) {
+  assert(dmx_num < DMX_NUM_MAX);
+  assert(dmx_driver_is_installed(dmx_num));
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  bool is_attached;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  is_attached = !driver->dmx.continuous.is_enabled;
+  if (is_attached && driver->rdm.dmx_data == NULL) {
+    driver->rdm.dmx_data = driver->dmx.data;
+    driver->dmx.data = driver->rdm.buffer;
+    driver->dmx.checksum_len = 0;
+    ++driver->dmx.generation;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return is_attached;
+}
+
+void dmx_buffer_detach_rdm(dmx_port_t dmx_num) {
+  assert(dmx_num < DMX_NUM_MAX);
+  assert(dmx_driver_is_installed(dmx_num));
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (driver->rdm.dmx_data != NULL) {
+    driver->dmx.data = driver->rdm.dmx_data;
+    driver->rdm.dmx_data = NULL;
+    driver->dmx.checksum_len = 0;
+    ++driver->dmx.generation;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+}
+
+size_t dmx_write(dmx_port_t dmx_num, const void *source, size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(source, 0, "source is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+
+  return dmx_write_offset(dmx_num, 0, source, size);
+}
+
+int dmx_write_slot(dmx_port_t dmx_num, size_t slot_num, uint8_t value) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, -1, "dmx_num error");
+  DMX_CHECK(slot_num < DMX_PACKET_SIZE_MAX, -1, "slot_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), -1, "driver is not installed");
+
+  dmx_write_offset(dmx_num, slot_num, &value, 1);
+
+  return value;
+}
+
+size_t dmx_write_scatter(dmx_port_t dmx_num, const dmx_iovec_t *vec,
+                         size_t num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(vec, 0, "vec is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+  for (int i = 0; i < num; ++i) {
+    DMX_CHECK(vec[i].offset < DMX_PACKET_SIZE_MAX, 0, "offset error");
+    DMX_CHECK(vec[i].source, 0, "source is null");
+  }
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Flip the DMX bus to write mode
+  if (dmx_uart_get_rts(dmx_num) == 1) {
+    dmx_uart_set_rts(dmx_num, 0);
+  }
+
+  // Copy every range to the staged buffer so they are published together
+  size_t written = 0;
+  dmx_staged_begin_write(dmx_num);
+  for (int i = 0; i < num; ++i) {
+    size_t size = vec[i].size;
+    if (size + vec[i].offset > DMX_PACKET_SIZE_MAX) {
+      size = DMX_PACKET_SIZE_MAX - vec[i].offset;
+    }
+    dmx_staged_copy(driver, vec[i].offset, vec[i].source, size);
+    written += size;
+  }
+  dmx_staged_end_write(dmx_num, written > 0);
+
+  return written;
+}
+
+static dmx_fade_t *dmx_fade_take(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Block until no other task is using the fade engine
+  xSemaphoreTake(driver->dmx.fade_mux, portMAX_DELAY);
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  dmx_fade_t *const fade = driver->dmx.fade;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return fade;
+}
+
+static void dmx_fade_give(dmx_port_t dmx_num) {
+  xSemaphoreGive(dmx_driver[dmx_num]->dmx.fade_mux);
+}
+
+static void dmx_fade_shrink(dmx_fade_t *fade) {
+  // Shrink the fade range to the slots which are still fading
+  while (fade->start < fade->end && fade->rate[fade->start] == 0) {
+    ++fade->start;
+  }
+  while (fade->end > fade->start && fade->rate[fade->end - 1] == 0) {
+    --fade->end;
+  }
+}
+
+static void dmx_fade_step(dmx_fade_t *fade, uint8_t *data, uint32_t ms) {
+  // Interpolate every slot in the fade range without branching
+  for (int i = fade->start; i < fade->end; ++i) {
+    const uint32_t rate = fade->rate[i];
+    uint32_t progress = fade->progress[i] + rate * ms;
+    progress = progress < DMX_FADE_ONE ? progress : DMX_FADE_ONE;
+    const int32_t delta = (int32_t)fade->to[i] - fade->from[i];
+    const int32_t lerp = (delta * (int32_t)(progress >> 8)) >> 16;
+    const uint8_t value = fade->from[i] + lerp;
+    data[i] = rate != 0 ? value : data[i];
+    fade->rate[i] = progress < DMX_FADE_ONE ? rate : 0;
+    fade->progress[i] = progress;
+  }
+
+  dmx_fade_shrink(fade);
+}
+
+static void dmx_fade_advance(dmx_fade_t *fade, uint8_t *data, int64_t now) {
+  // Advance the fades in whole milliseconds, keeping the remainder
+  uint32_t ms = (now - fade->last_update) / 1000;
+  fade->last_update += (int64_t)ms * 1000;
+  if (fade->start >= fade->end) {
+    fade->last_update = now;
+    return;
+  }
+
+  // Limit each step so that the fade progress can't overflow
+  while (ms > 0 && fade->start < fade->end) {
+    const uint32_t step = ms < 127 ? ms : 127;
+    dmx_fade_step(fade, data, step);
+    ms -= step;
+  }
+}
+
+static void dmx_fade_update(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  dmx_fade_t *const fade = dmx_fade_take(dmx_num);
+  if (fade == NULL) {
+    dmx_fade_give(dmx_num);
+    return;  // No fade has been started
+  }
+
+  if (fade->start < fade->end) {
+    dmx_staged_begin_write(dmx_num);
+    dmx_staged_mark(driver, fade->start, fade->end);
+    dmx_fade_advance(fade, driver->dmx.staged.data,
+                     dmx_timer_get_micros_since_boot());
+    dmx_staged_end_write(dmx_num, true);
+  }
+
+  dmx_fade_give(dmx_num);
+}
+
+size_t dmx_fade_start(dmx_port_t dmx_num, size_t offset, const void *targets,
+                      size_t size, uint32_t duration_ms) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(offset < DMX_PACKET_SIZE_MAX, 0, "offset error");
+  DMX_CHECK(targets, 0, "targets is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+
+  // Clamp size to the maximum DMX packet size
+  if (size + offset > DMX_PACKET_SIZE_MAX) {
+    size = DMX_PACKET_SIZE_MAX - offset;
+  } else if (size == 0) {
+    return 0;
+  }
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Allocate the fade engine the first time that a fade is started
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  const bool needs_alloc = driver->dmx.fade == NULL;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (needs_alloc) {
+    dmx_fade_t *fade = heap_caps_malloc(sizeof(dmx_fade_t), MALLOC_CAP_8BIT);
+    DMX_CHECK(fade != NULL, 0, "fade malloc error");
+    memset(fade, 0, sizeof(dmx_fade_t));
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (driver->dmx.fade == NULL) {
+      driver->dmx.fade = fade;
+      fade = NULL;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+    heap_caps_free(fade);  // Another task allocated the fade engine first
+  }
+
+  // Flip the DMX bus to write mode
+  if (dmx_uart_get_rts(dmx_num) == 1) {
+    dmx_uart_set_rts(dmx_num, 0);
+  }
+
+  /* Fades are evaluated when a packet is sent with dmx_send(), which is never
+  called in continuous mode. Continuous mode is checked while the fade engine
+  is held so that it can't be enabled while the fade is started.*/
+  dmx_fade_t *const fade = dmx_fade_take(dmx_num);
+  if (dmx_continuous_is_enabled(dmx_num)) {
+    dmx_fade_give(dmx_num);
+    DMX_CHECK(false, 0, "continuous mode is enabled");
+  }
+  dmx_staged_begin_write(dmx_num);
+  uint8_t *const data = driver->dmx.staged.data;
+
+  // Bring the fades up to date so that the new fades begin now
+  if (fade->start < fade->end) {
+    dmx_staged_mark(driver, fade->start, fade->end);
+  }
+  dmx_fade_advance(fade, data, dmx_timer_get_micros_since_boot());
+
+  // Fades with a duration of 0 are written immediately
+  uint32_t rate = 0;
+  if (duration_ms == 0) {
+    dmx_staged_copy(driver, offset, targets, size);
+  } else {
+    rate = DMX_FADE_ONE / duration_ms;
+    if (rate == 0) {
+      rate = 1;
+    }
+  }
+
+  // Start the fade of each slot from its current value
+  const uint8_t *const to = targets;
+  for (int i = 0; i < size; ++i) {
+    const int slot_num = dmx_patch_get(driver, offset + i);
+    if (slot_num < 0) {
+      continue;  // Slot is not patched
+    }
+    fade->from[slot_num] = data[slot_num];
+    fade->to[slot_num] = to[i];
+    fade->progress[slot_num] = rate != 0 ? 0 : DMX_FADE_ONE;
+    fade->rate[slot_num] = rate;
+    dmx_staged_mark(driver, slot_num, slot_num + 1);
+    dmx_staged_extend(driver, slot_num + 1);
+    if (rate == 0) {
+      continue;
+    } else if (fade->start >= fade->end) {
+      fade->start = slot_num;
+      fade->end = slot_num + 1;
+    } else {
+      fade->start = slot_num < fade->start ? slot_num : fade->start;
+      fade->end = slot_num + 1 > fade->end ? slot_num + 1 : fade->end;
+    }
+  }
+
+  dmx_staged_end_write(dmx_num, true);
+  dmx_fade_give(dmx_num);
+
+  return size;
+}
+
+bool dmx_fade_stop(dmx_port_t dmx_num, size_t offset, size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(offset < DMX_PACKET_SIZE_MAX, false, "offset error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  // Clamp size to the maximum DMX packet size
+  if (size + offset > DMX_PACKET_SIZE_MAX) {
+    size = DMX_PACKET_SIZE_MAX - offset;
   }
 
   dmx_driver_t *const driver = dmx_driver[dmx_num];
 
-  // Copy data from the driver buffer to the destination asynchronously
-  memcpy(destination, driver->dmx.data + offset, size);
+  dmx_fade_t *const fade = dmx_fade_take(dmx_num);
+  if (fade == NULL) {
+    dmx_fade_give(dmx_num);
+    return true;  // No fade has been started
+  }
 
-  return size;
+  // Hold each slot at its current value
+  const bool is_fading = fade->start < fade->end;
+  dmx_staged_begin_write(dmx_num);
+  if (is_fading) {
+    dmx_staged_mark(driver, fade->start, fade->end);
+  }
+  dmx_fade_advance(fade, driver->dmx.staged.data,
+                   dmx_timer_get_micros_since_boot());
+  dmx_staged_end_write(dmx_num, is_fading);
+  for (int i = offset; i < offset + size; ++i) {
+    const int slot_num = dmx_patch_get(driver, i);
+    if (slot_num >= 0) {
+      fade->rate[slot_num] = 0;
+    }
+  }
+  dmx_fade_shrink(fade);
+
+  dmx_fade_give(dmx_num);
+
+  return true;
 }
 
-size_t dmx_read(dmx_port_t dmx_num, void *destination, size_t size) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
-  DMX_CHECK(destination, 0, "destination is null");
-  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+bool dmx_fade_is_active(dmx_port_t dmx_num) {
+  bool is_active = false;
+  if (dmx_driver_is_installed(dmx_num)) {
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    const dmx_fade_t *const fade = dmx_driver[dmx_num]->dmx.fade;
+    if (fade != NULL) {
+      is_active = fade->start < fade->end;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  }
 
-  return dmx_read_offset(dmx_num, 0, destination, size);
+  return is_active;
 }
 
-int dmx_read_slot(dmx_port_t dmx_num, size_t slot_num) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, -1, "dmx_num error");
-  DMX_CHECK(slot_num < DMX_PACKET_SIZE_MAX, -1, "slot_num error");
-  DMX_CHECK(dmx_driver_is_installed(dmx_num), -1, "driver is not installed");
+static bool dmx_merge_init(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
 
-  uint8_t slot;
-  dmx_read_offset(dmx_num, slot_num, &slot, 1);
+  // Allocate the merge engine the first time that it is used
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  const bool needs_alloc = driver->dmx.merge == NULL;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (needs_alloc) {
+    dmx_merge_t *merge =
+        heap_caps_malloc(sizeof(dmx_merge_t), MALLOC_CAP_8BIT);
+    if (merge == NULL) {
+      return false;
+    }
+    memset(merge, 0, sizeof(dmx_merge_t));
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (driver->dmx.merge == NULL) {
+      driver->dmx.merge = merge;
+      merge = NULL;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+    heap_caps_free(merge);  // Another task allocated the merge engine first
+  }
 
-  return slot;
+  return true;
 }
 
-size_t dmx_write_offset(dmx_port_t dmx_num, size_t offset, const void *source,
-                        size_t size) {
+static dmx_merge_t *dmx_merge_take(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Block until no other task is using the merge engine
+  xSemaphoreTake(driver->dmx.merge_mux, portMAX_DELAY);
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  dmx_merge_t *const merge = driver->dmx.merge;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return merge;
+}
+
+static void dmx_merge_give(dmx_port_t dmx_num) {
+  xSemaphoreGive(dmx_driver[dmx_num]->dmx.merge_mux);
+}
+
+static inline uint32_t dmx_merge_max4(uint32_t a, uint32_t b) {
+  // Compare two bytes in each 16-bit lane; bit 8 is set where a >= b
+  const uint32_t lanes = 0x00ff00ff;
+  uint32_t a_lo = a & lanes, b_lo = b & lanes;
+  uint32_t a_hi = (a >> 8) & lanes, b_hi = (b >> 8) & lanes;
+  uint32_t ge_lo = ((a_lo | 0x01000100) - b_lo) & 0x01000100;
+  uint32_t ge_hi = ((a_hi | 0x01000100) - b_hi) & 0x01000100;
+  ge_lo -= ge_lo >> 8;  // Expand each comparison to a byte mask
+  ge_hi -= ge_hi >> 8;
+
+  const uint32_t max_lo = (a_lo & ge_lo) | (b_lo & ~ge_lo);
+  const uint32_t max_hi = (a_hi & ge_hi) | (b_hi & ~ge_hi);
+  return max_lo | (max_hi << 8);
+}
+
+void dmx_merge_update(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  dmx_merge_t *const merge = dmx_merge_take(dmx_num);
+  if (merge == NULL) {
+    dmx_merge_give(dmx_num);
+    return;  // No source has been written
+  } else if (merge->active == 0) {
+    dmx_merge_give(dmx_num);
+    return;  // Every source has been released
+  }
+
+  // Only the sources with the highest priority are merged
+  uint32_t winners = 0;
+  int priority = -1;
+  int latest = 0;
+  for (int i = 0; i < DMX_MERGE_SOURCE_MAX; ++i) {
+    if (!(merge->active & (1 << i)) || merge->priority[i] < priority) {
+      continue;
+    } else if (merge->priority[i] > priority) {
+      priority = merge->priority[i];
+      winners = 0;
+      latest = i;
+    }
+    winners |= 1 << i;
+    if ((int32_t)(merge->seq[i] - merge->seq[latest]) > 0) {
+      latest = i;
+    }
+  }
+
+  const uint32_t *in[DMX_MERGE_SOURCE_MAX];
+  int in_count = 0;
+  for (int i = 0; i < DMX_MERGE_SOURCE_MAX; ++i) {
+    if (winners & (1 << i)) {
+      in[in_count++] = (const uint32_t *)merge->sources[i];
+    }
+  }
+
+  // Find the words of the staged buffer which overlap the footprint
+  const int words = DMX_BUFFER_SIZE / sizeof(uint32_t);
+  int first = words;
+  int last = 0;
+  for (int w = 0; w < words; ++w) {
+    if ((merge->footprint[w / 8] >> (w % 8 * 4)) & 0xf) {
+      first = w < first ? w : first;
+      last = w + 1;
+    }
+  }
+  if (first >= last) {
+    dmx_merge_give(dmx_num);
+    return;  // Only the start code has been written
+  }
+  const int end =
+      last * 4 < DMX_PACKET_SIZE_MAX ? last * 4 : DMX_PACKET_SIZE_MAX;
+
+  dmx_staged_begin_write(dmx_num);
+  dmx_staged_mark(driver, first * 4, end);
+  uint8_t *const data = driver->dmx.staged.data;
+
+  /* Merge the footprint highest takes precedence, one word at a time. Slots
+  outside of the footprint keep the DMX data written with dmx_write(), so each
+  word is blended using a byte mask which is built from the four footprint bits
+  of the word. Slot 4w+k is byte k of word w on little-endian targets.*/
+  uint32_t *const out = (uint32_t *)data;
+  for (int w = first; w < last; ++w) {
+    const uint32_t bits = (merge->footprint[w / 8] >> (w % 8 * 4)) & 0xf;
+    const uint32_t mask = ((bits * 0x00204081) & 0x01010101) * 0xff;
+    uint32_t merged = 0;
+    for (int i = 0; i < in_count; ++i) {
+      merged = dmx_merge_max4(merged, in[i][w]);
+    }
+    out[w] = (merged & mask) | (out[w] & ~mask);
+  }
+
+  // Overwrite latest takes precedence slots with the source that changed them
+  for (int w = 0; w < DMX_SLOT_BITMAP_LEN; ++w) {
+    uint32_t bits = merge->ltp[w] & merge->footprint[w];
+    while (bits) {
+      const int slot_num = w * 32 + __builtin_ctz(bits);
+      bits &= bits - 1;
+      int owner = merge->owner[slot_num];
+      if (!(winners & (1 << owner))) {
+        owner = latest;
+      }
+      data[slot_num] = merge->sources[owner][slot_num];
+    }
+  }
+
+  dmx_staged_end_write(dmx_num, true);
+  dmx_merge_give(dmx_num);
+}
+
+static void dmx_staged_update(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Don't overwrite an RDM packet which has been written but not sent
+  bool is_rdm;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  is_rdm = driver->rdm.dmx_data != NULL ||
+           (!driver->dmx.staged.is_pending && driver->dmx.data[0] == RDM_SC);
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (is_rdm) {
+    return;
+  }
+
+  dmx_merge_update(dmx_num);
+  dmx_fade_update(dmx_num);
+}
+
+size_t dmx_merge_write(dmx_port_t dmx_num, int source_num, size_t offset,
+                       const void *source, size_t size) {
   DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(source_num >= 0 && source_num < DMX_MERGE_SOURCE_MAX, 0,
+            "source_num error");
   DMX_CHECK(offset < DMX_PACKET_SIZE_MAX, 0, "offset error");
   DMX_CHECK(source, 0, "source is null");
   DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
@@ -68,50 +1027,173 @@ size_t dmx_write_offset(dmx_port_t dmx_num, size_t offset, const void *source,
 
   dmx_driver_t *const driver = dmx_driver[dmx_num];
 
-  // Check if the driver is currently sending an RDM packet
-  int dmx_status;
-  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
-  dmx_status = driver->dmx.status;
-  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
-  if (dmx_status == DMX_STATUS_SENDING) {
-    rdm_header_t header;
-    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
-    const bool is_rdm = rdm_read_header(dmx_num, &header);
-    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
-    if (is_rdm) {
-      return 0;  // Do not allow asynchronous writes while sending RDM
-    }
-  }
+  DMX_CHECK(dmx_merge_init(dmx_num), 0, "merge malloc error");
 
   // Flip the DMX bus to write mode
   if (dmx_uart_get_rts(dmx_num) == 1) {
     dmx_uart_set_rts(dmx_num, 0);
   }
 
-  // Copy data from the source to the driver buffer asynchronously
+  /* Merges are evaluated when a packet is sent with dmx_send(), which is never
+  called in continuous mode. Continuous mode is checked while the merge engine
+  is held so that it can't be enabled while the source is written.*/
+  dmx_merge_t *const merge = dmx_merge_take(dmx_num);
+  if (dmx_continuous_is_enabled(dmx_num)) {
+    dmx_merge_give(dmx_num);
+    DMX_CHECK(false, 0, "continuous mode is enabled");
+  }
+
+  /* Record which source changed each slot for latest takes precedence, and
+  add the slots to the footprint. The start code is never merged.*/
+  uint8_t *const dest = merge->sources[source_num];
+  const uint8_t *const src = source;
+  for (int i = 0; i < size; ++i) {
+    const int slot_num = dmx_patch_get(driver, offset + i);
+    if (slot_num <= 0) {
+      continue;
+    } else if (dest[slot_num] != src[i]) {
+      merge->owner[slot_num] = source_num;
+    }
+    merge->footprint[slot_num / 32] |= (uint32_t)1 << (slot_num % 32);
+  }
+  int start;
+  dmx_staged_extend(driver,
+                    dmx_patch_copy(driver, dest, offset, src, size, &start));
+  merge->active |= 1 << source_num;
+  merge->seq[source_num] = ++merge->write_count;
+
+  dmx_merge_give(dmx_num);
+
+  return size;
+}
+
+bool dmx_merge_release(dmx_port_t dmx_num, int source_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(source_num >= 0 && source_num < DMX_MERGE_SOURCE_MAX, false,
+            "source_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_merge_t *const merge = dmx_merge_take(dmx_num);
+  if (merge == NULL) {
+    dmx_merge_give(dmx_num);
+    return true;  // No source has been written
+  }
+  merge->active &= ~(1 << source_num);
+  memset(merge->sources[source_num], 0, DMX_BUFFER_SIZE);
+  dmx_merge_give(dmx_num);
+
+  return true;
+}
+
+bool dmx_merge_set_priority(dmx_port_t dmx_num, int source_num,
+                            uint8_t priority) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(source_num >= 0 && source_num < DMX_MERGE_SOURCE_MAX, false,
+            "source_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  DMX_CHECK(dmx_merge_init(dmx_num), false, "merge malloc error");
+
+  dmx_merge_t *const merge = dmx_merge_take(dmx_num);
+  if (dmx_continuous_is_enabled(dmx_num)) {
+    dmx_merge_give(dmx_num);
+    DMX_CHECK(false, false, "continuous mode is enabled");
+  }
+  merge->priority[source_num] = priority;
+  dmx_merge_give(dmx_num);
+
+  return true;
+}
+
+bool dmx_merge_set_policy(dmx_port_t dmx_num, size_t offset, size_t size,
+                          int policy) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(offset < DMX_PACKET_SIZE_MAX, false, "offset error");
+  DMX_CHECK(policy == DMX_MERGE_HTP || policy == DMX_MERGE_LTP, false,
+            "policy error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  // Clamp size to the maximum DMX packet size
+  if (size + offset > DMX_PACKET_SIZE_MAX) {
+    size = DMX_PACKET_SIZE_MAX - offset;
+  }
+
+  DMX_CHECK(dmx_merge_init(dmx_num), false, "merge malloc error");
+
+  dmx_merge_t *const merge = dmx_merge_take(dmx_num);
+  if (dmx_continuous_is_enabled(dmx_num)) {
+    dmx_merge_give(dmx_num);
+    DMX_CHECK(false, false, "continuous mode is enabled");
+  }
+  for (int i = offset; i < offset + size; ++i) {
+    const uint32_t mask = (uint32_t)1 << (i % 32);
+    if (policy == DMX_MERGE_LTP) {
+      merge->ltp[i / 32] |= mask;
+    } else {
+      merge->ltp[i / 32] &= ~mask;
+    }
+  }
+  dmx_merge_give(dmx_num);
+
+  return true;
+}
+
+bool dmx_patch_set(dmx_port_t dmx_num, size_t logical, size_t physical) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(logical > 0 && logical < DMX_PACKET_SIZE_MAX, false,
+            "logical error");
+  DMX_CHECK(physical < DMX_PACKET_SIZE_MAX, false, "physical error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Allocate the patch table the first time that a slot is patched
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  const bool needs_alloc = driver->dmx.patch.table == NULL;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (needs_alloc) {
+    const size_t table_size = sizeof(uint16_t) * DMX_PACKET_SIZE_MAX;
+    uint16_t *table = heap_caps_malloc(table_size, MALLOC_CAP_8BIT);
+    DMX_CHECK(table != NULL, false, "patch table malloc error");
+    memset(table, 0, table_size);
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (driver->dmx.patch.table == NULL) {
+      driver->dmx.patch.table = table;
+      table = NULL;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+    heap_caps_free(table);  // Another task allocated the patch table first
+  }
+
   taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
-  memcpy(driver->dmx.data + offset, source, size);
+  if (!driver->dmx.patch.is_enabled) {
+    memset(driver->dmx.patch.table, 0, sizeof(uint16_t) * DMX_PACKET_SIZE_MAX);
+    driver->dmx.patch.is_enabled = true;
+  }
+  driver->dmx.patch.table[logical] = physical;
   taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
 
-  return size;
+  return true;
 }
 
-size_t dmx_write(dmx_port_t dmx_num, const void *source, size_t size) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
-  DMX_CHECK(source, 0, "source is null");
-  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+bool dmx_patch_set_16bit(dmx_port_t dmx_num, size_t logical, size_t coarse,
+                         size_t fine) {
+  DMX_CHECK(logical + 1 < DMX_PACKET_SIZE_MAX, false, "logical error");
 
-  return dmx_write_offset(dmx_num, 0, source, size);
+  return dmx_patch_set(dmx_num, logical, coarse) &&
+         dmx_patch_set(dmx_num, logical + 1, fine);
 }
 
-int dmx_write_slot(dmx_port_t dmx_num, size_t slot_num, uint8_t value) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, -1, "dmx_num error");
-  DMX_CHECK(slot_num < DMX_PACKET_SIZE_MAX, -1, "slot_num error");
-  DMX_CHECK(dmx_driver_is_installed(dmx_num), -1, "driver is not installed");
+bool dmx_patch_clear(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
 
-  dmx_write_offset(dmx_num, slot_num, &value, 1);
+  // The patch table is kept so that it does not need to be allocated again
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  dmx_driver[dmx_num]->dmx.patch.is_enabled = false;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
 
-  return value;
+  return true;
 }
 
 size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
@@ -132,6 +1214,8 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
       packet->sc = -1;
       packet->size = 0;
       packet->is_rdm = 0;
+      packet->break_timestamp = -1;
+      packet->eop_timestamp = -1;
     }
     return 0;
   } else if (!dmx_wait_sent(dmx_num, wait_ticks) ||
@@ -142,6 +1226,8 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
       packet->sc = -1;
       packet->size = 0;
       packet->is_rdm = 0;
+      packet->break_timestamp = -1;
+      packet->eop_timestamp = -1;
     }
     return 0;
   }
@@ -185,6 +1271,8 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
       packet->sc = -1;
       packet->size = 0;
       packet->is_rdm = 0;
+      packet->break_timestamp = -1;
+      packet->eop_timestamp = -1;
     }
     xSemaphoreGiveRecursive(driver->mux);
     return 0;
@@ -222,6 +1310,8 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
           packet->sc = -1;
           packet->size = 0;
           packet->is_rdm = 0;
+          packet->break_timestamp = -1;
+          packet->eop_timestamp = -1;
         }
         xSemaphoreGiveRecursive(driver->mux);
         return 0;
@@ -236,7 +1326,10 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
     }
 
     // Wait for the DMX driver to notify this task that DMX is ready
+    DMX_TRACE(dmx_num, DMX_TRACE_RECEIVE_WAIT, size);
     const bool notified = xTaskNotifyWait(0, -1, (uint32_t *)&err, wait_ticks);
+    DMX_TRACE(dmx_num, DMX_TRACE_RECEIVE_WOKEN,
+              notified ? err : DMX_ERR_TIMEOUT);
     taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
     packet_size = driver->dmx.head;
     driver->task_waiting = NULL;
@@ -248,6 +1341,8 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
         packet->sc = -1;
         packet->size = 0;
         packet->is_rdm = 0;
+        packet->break_timestamp = -1;
+        packet->eop_timestamp = -1;
       }
       xSemaphoreGiveRecursive(driver->mux);
       dmx_parameter_commit(dmx_num);
@@ -262,10 +1357,26 @@ size_t dmx_receive_num(dmx_port_t dmx_num, dmx_packet_t *packet, size_t size,
   }
 
   // Parse DMX packet data
+  bool is_early;
   taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
-  driver->dmx.progress = DMX_PROGRESS_STALE;  // Prevent parsing old data
+  is_early = driver->dmx.progress == DMX_PROGRESS_IN_DATA &&
+             driver->dmx.window.is_notified;
+  if (driver->dmx.window.size == 0 ||
+      driver->dmx.progress == DMX_PROGRESS_COMPLETE) {
+    // Packets which woke this task early are still being received
+    driver->dmx.progress = DMX_PROGRESS_STALE;  // Prevent parsing old data
+  }
   taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
   if (packet != NULL) {
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (is_early) {
+      packet->break_timestamp = driver->dmx.rx_break_timestamp;
+      packet->eop_timestamp = -1;
+    } else {
+      packet->break_timestamp = driver->dmx.last_rx_break_timestamp;
+      packet->eop_timestamp = driver->dmx.last_rx_eop_timestamp;
+    }
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
     if (packet_size > 0) {
       taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
       packet->sc = driver->dmx.data[0];
@@ -288,44 +1399,251 @@ size_t dmx_receive(dmx_port_t dmx_num, dmx_packet_t *packet,
   DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
   DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
 
-  size_t size;
+  size_t size;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  size = dmx_driver[dmx_num]->dmx.size;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return dmx_receive_num(dmx_num, packet, size, wait_ticks);
+}
+
+size_t dmx_receive_footprint(dmx_port_t dmx_num, dmx_packet_t *packet,
+                             TickType_t wait_ticks) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+  DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Get the number of slots which covers the footprint of this device
+  int window = 0;
+  const uint16_t start_address = dmx_get_start_address(dmx_num);
+  const uint8_t personality = dmx_get_current_personality(dmx_num);
+  if (start_address != DMX_START_ADDRESS_NONE && personality > 0) {
+    const size_t footprint = dmx_get_footprint(dmx_num, personality);
+    if (footprint > 0) {
+      window = start_address + footprint;
+      if (window > DMX_PACKET_SIZE_MAX) {
+        window = DMX_PACKET_SIZE_MAX;
+      }
+    }
+  }
+
+  // The window must only be used while this task holds the mutex
+  TimeOut_t timeout;
+  vTaskSetTimeOutState(&timeout);
+  if (!xSemaphoreTakeRecursive(driver->mux, wait_ticks)) {
+    if (packet != NULL) {
+      packet->err = DMX_ERR_TIMEOUT;
+      packet->sc = -1;
+      packet->size = 0;
+      packet->is_rdm = 0;
+      packet->break_timestamp = -1;
+      packet->eop_timestamp = -1;
+    }
+    return 0;
+  }
+  if (wait_ticks) {
+    xTaskCheckForTimeOut(&timeout, &wait_ticks);  // Updates wait_ticks
+  }
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.window.size = window;
+  if (driver->dmx.progress == DMX_PROGRESS_IN_DATA) {
+    dmx_uart_set_rxfifo_full_threshold(dmx_num, 1);  // Re-evaluate the batch
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  const size_t packet_size = dmx_receive(dmx_num, packet, wait_ticks);
+
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.window.size = 0;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  xSemaphoreGiveRecursive(driver->mux);
+
+  return packet_size;
+}
+
+bool dmx_get_stats(dmx_port_t dmx_num, dmx_stats_t *stats) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(stats, false, "stats is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Copy the statistics, retrying if the UART ISR updated them during the copy
+  int64_t last_packet_timestamp;
+  uint32_t seq;
+  do {
+    seq = __atomic_load_n(&driver->stats.seq, __ATOMIC_ACQUIRE);
+    memcpy(stats, &driver->stats.values, sizeof(*stats));
+    last_packet_timestamp = driver->stats.last_packet_timestamp;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) ||
+           __atomic_load_n(&driver->stats.seq, __ATOMIC_RELAXED) != seq);
+
+  // Derive the refresh rate from the average packet interval
+  const int64_t timeout = (int64_t)DMX_TIMEOUT_TICK * portTICK_PERIOD_MS * 1000;
+  if (stats->interval == 0 || last_packet_timestamp < 0 ||
+      dmx_timer_get_micros_since_boot() - last_packet_timestamp > timeout) {
+    stats->refresh_rate = 0;  // The signal was lost
+  } else {
+    stats->refresh_rate = (1000000 + stats->interval / 2) / stats->interval;
+  }
+
+  return true;
+}
+
+static bool dmx_router_init(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Allocate the start code router the first time that it is used
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  const bool needs_alloc = driver->dmx.router == NULL;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (needs_alloc) {
+    dmx_router_t *router =
+        heap_caps_malloc(sizeof(dmx_router_t), MALLOC_CAP_8BIT);
+    if (router == NULL) {
+      return false;
+    }
+    bool is_allocated = true;
+    for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+      router->routes[i].sc = -1;
+      router->routes[i].seq = 0;
+      router->routes[i].read_seq = 0;
+      router->routes[i].size = 0;
+      router->routes[i].semaphore = xSemaphoreCreateBinary();
+      if (router->routes[i].semaphore == NULL) {
+        is_allocated = false;
+      }
+    }
+    if (is_allocated) {
+      taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+      if (driver->dmx.router == NULL) {
+        driver->dmx.router = router;
+        router = NULL;
+      }
+      taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+    }
+    if (router != NULL) {
+      // Another task allocated the router first or a semaphore wasn't created
+      for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+        if (router->routes[i].semaphore != NULL) {
+          vSemaphoreDelete(router->routes[i].semaphore);
+        }
+      }
+      heap_caps_free(router);
+      if (!is_allocated) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool dmx_start_code_register(dmx_port_t dmx_num, uint8_t sc) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(!dmx_start_code_is_rdm(sc), false, "sc error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+  DMX_CHECK(dmx_router_init(dmx_num), false, "router malloc error");
+
+  dmx_router_t *const router = dmx_driver[dmx_num]->dmx.router;
+
+  // Claim an unused route unless the start code is already registered
+  int route_num = -1;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+    if (router->routes[i].sc == sc) {
+      route_num = i;
+      break;
+    } else if (route_num < 0 && router->routes[i].sc == -1) {
+      route_num = i;
+    }
+  }
+  if (route_num >= 0 && router->routes[route_num].sc != sc) {
+    struct dmx_router_route_t *const route = &router->routes[route_num];
+    route->sc = sc;
+    route->read_seq = (route->seq + 1) & ~1;  // Don't read the previous route
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_CHECK(route_num >= 0, false, "no start code routes are available");
+
+  return true;
+}
+
+bool dmx_start_code_unregister(dmx_port_t dmx_num, uint8_t sc) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  dmx_router_t *const router = dmx_driver[dmx_num]->dmx.router;
+  DMX_CHECK(router != NULL, false, "start code is not registered");
+
+  bool was_registered = false;
   taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
-  size = dmx_driver[dmx_num]->dmx.size;
+  for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+    if (router->routes[i].sc == sc) {
+      router->routes[i].sc = -1;
+      was_registered = true;
+      break;
+    }
+  }
   taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_CHECK(was_registered, false, "start code is not registered");
 
-  return dmx_receive_num(dmx_num, packet, size, wait_ticks);
+  return true;
 }
 
-size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
+size_t dmx_receive_start_code(dmx_port_t dmx_num, uint8_t sc,
+                              void *destination, size_t size,
+                              TickType_t wait_ticks) {
   DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(destination, 0, "destination is null");
   DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
-  DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
 
-  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  dmx_router_t *const router = dmx_driver[dmx_num]->dmx.router;
+  DMX_CHECK(router != NULL, 0, "start code is not registered");
 
-  // Block until the mutex can be taken
-  if (!xSemaphoreTakeRecursive(driver->mux, 0)) {
-    return 0;
+  struct dmx_router_route_t *route = NULL;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  for (int i = 0; i < DMX_START_CODE_ROUTE_MAX; ++i) {
+    if (router->routes[i].sc == sc) {
+      route = &router->routes[i];
+      break;
+    }
   }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_CHECK(route != NULL, 0, "start code is not registered");
 
-  // Block until the driver is done sending
-  if (!dmx_wait_sent(dmx_num, dmx_ms_to_ticks(23))) {
-    xSemaphoreGiveRecursive(driver->mux);
-    return 0;
-  }
+  TimeOut_t timeout;
+  vTaskSetTimeOutState(&timeout);
+  while (true) {
+    // Copy the packet, retrying if another packet was routed during the copy
+    const uint32_t seq = __atomic_load_n(&route->seq, __ATOMIC_ACQUIRE);
+    if (!(seq & 1) && seq != route->read_seq) {
+      size_t packet_size = route->size;
+      if (packet_size > size) {
+        packet_size = size;
+      }
+      memcpy(destination, route->data, packet_size);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&route->seq, __ATOMIC_RELAXED) == seq) {
+        route->read_seq = seq;
+        return packet_size;
+      }
+      continue;
+    }
 
-  // Determine if the packet was an RDM packet
-  bool is_rdm;
-  rdm_header_t header;
-  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
-  is_rdm = rdm_read_header(dmx_num, &header);
-  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
-  if (is_rdm && !rdm_cc_is_valid(header.cc)) {
-    is_rdm = false;
+    // Wait for the DMX driver to route the next packet
+    if (xTaskCheckForTimeOut(&timeout, &wait_ticks) ||
+        !xSemaphoreTake(route->semaphore, wait_ticks)) {
+      return 0;
+    }
   }
+}
 
-  // Determine if this device is the controller
-  driver->is_controller = !is_rdm || rdm_cc_is_request(header.cc);
+static int64_t dmx_get_packet_spacing(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
 
   // Determine if it is necessary to set a hardware timeout alarm
   int64_t timer_alarm;
@@ -354,6 +1672,27 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
     timer_alarm = RDM_TIMING_RESPONDER_MIN;
   }
 
+  /* Short packets can be sent faster than the DMX standard allows, so respect
+  the minimum time between the start of two DMX breaks when adaptive packet
+  length is enabled.*/
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (driver->is_controller && driver->dmx.auto_size.is_enabled) {
+    const int64_t break_to_break = driver->dmx.auto_size.break_to_break;
+    const int64_t break_to_eop =
+        driver->dmx.controller_eop_timestamp - driver->dmx.break_timestamp;
+    if (break_to_break - break_to_eop > timer_alarm) {
+      timer_alarm = break_to_break - break_to_eop;
+    }
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return timer_alarm;
+}
+
+static int64_t dmx_wait_packet_spacing(dmx_port_t dmx_num) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  const int64_t timer_alarm = dmx_get_packet_spacing(dmx_num);
+
   // If necessary, set an alarm to wait the minimum duration before sending
   int64_t timer_elapsed;
   const TaskHandle_t this_task_handle = xTaskGetCurrentTaskHandle();
@@ -376,9 +1715,64 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
     driver->task_waiting = NULL;
   }
 
+  return timer_elapsed;
+}
+
+static size_t dmx_send_packet(dmx_port_t dmx_num, size_t size,
+                              bool is_blocking) {
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Block until the mutex can be taken
+  if (!xSemaphoreTakeRecursive(driver->mux, 0)) {
+    return 0;
+  }
+
+  // Block until the driver is done sending
+  if (!dmx_wait_sent(dmx_num, dmx_ms_to_ticks(23))) {
+    xSemaphoreGiveRecursive(driver->mux);
+    return 0;
+  }
+
+  // Merge, fade, and publish DMX data written since the last packet was sent
+  dmx_staged_update(dmx_num);
+  dmx_staged_publish(dmx_num);
+
+  // Determine if the packet was an RDM packet
+  bool is_rdm;
+  rdm_header_t header;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  is_rdm = rdm_read_header(dmx_num, &header);
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (is_rdm && !rdm_cc_is_valid(header.cc)) {
+    is_rdm = false;
+  }
+
+  // Determine if this device is the controller
+  driver->is_controller = !is_rdm || rdm_cc_is_request(header.cc);
+
+  /* Wait the minimum duration before sending. If not blocking, the DMX break
+  is instead started by the timer ISR once the minimum duration has elapsed.
+  RDM discovery responses don't begin with a DMX break, so they always wait.*/
+  const bool is_disc_response = is_rdm &&
+                                header.cc == RDM_CC_DISC_COMMAND_RESPONSE &&
+                                header.pid == RDM_PID_DISC_UNIQUE_BRANCH;
+  int64_t timer_alarm = 0;
+  int64_t timer_elapsed;
+  if (is_blocking || is_disc_response) {
+    timer_elapsed = dmx_wait_packet_spacing(dmx_num);
+  } else {
+    timer_alarm = dmx_get_packet_spacing(dmx_num);
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    timer_elapsed = dmx_timer_get_micros_since_boot() -
+                    driver->dmx.controller_eop_timestamp;
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  }
+  const bool is_deferred = timer_elapsed < timer_alarm;
+
   // Return early if it is too late to send a response packet
   if (!driver->is_controller) {
     if (timer_elapsed > RDM_TIMING_RESPONDER_MAX) {
+      DMX_TRACE(dmx_num, DMX_TRACE_SEND_TOO_LATE, timer_elapsed);
       xSemaphoreGiveRecursive(driver->mux);
       return 0;
     }
@@ -405,6 +1799,7 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
   taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
   driver->dmx.size = size;
   taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  DMX_TRACE(dmx_num, DMX_TRACE_SEND, size);
 
   // Record information about the packet that is being sent
   if (driver->is_controller) {
@@ -427,8 +1822,7 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
   }
 
   // Determine if a DMX break is required and send the packet
-  if (is_rdm && header.cc == RDM_CC_DISC_COMMAND_RESPONSE &&
-      header.pid == RDM_PID_DISC_UNIQUE_BRANCH) {
+  if (is_disc_response) {
     // RDM discovery responses do not send a DMX break - write immediately
     taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
     driver->dmx.status = DMX_STATUS_SENDING;
@@ -440,6 +1834,16 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
     // Enable DMX write interrupts
     dmx_uart_enable_interrupt(dmx_num, DMX_INTR_TX_ALL);
     taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  } else if (is_deferred) {
+    // Set an alarm to start the DMX break when the minimum duration elapses
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    driver->dmx.head = 0;
+    driver->dmx.progress = DMX_PROGRESS_IN_SPACING;
+    driver->dmx.status = DMX_STATUS_SENDING;
+    dmx_timer_set_counter(dmx_num, timer_elapsed);
+    dmx_timer_set_alarm(dmx_num, timer_alarm, false);
+    dmx_timer_start(dmx_num);
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
   } else {
     // Send the packet by starting the DMX break
     taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
@@ -451,6 +1855,9 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
     dmx_timer_start(dmx_num);
 
     dmx_uart_invert_tx(dmx_num, 1);
+    if (driver->is_controller) {
+      driver->dmx.break_timestamp = dmx_timer_get_micros_since_boot();
+    }
     taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
   }
 
@@ -459,12 +1866,355 @@ size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
   return size;
 }
 
+size_t dmx_send_num(dmx_port_t dmx_num, size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+  DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
+  DMX_CHECK(!dmx_continuous_is_enabled(dmx_num), 0,
+            "continuous mode is enabled");
+
+  return dmx_send_packet(dmx_num, size, true);
+}
+
 size_t dmx_send(dmx_port_t dmx_num) {
   DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
   DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
   DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
 
-  return dmx_send_num(dmx_num, DMX_PACKET_SIZE);
+  // Send DMX packets up to the highest slot that was written, if enabled
+  size_t size = DMX_PACKET_SIZE;
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (driver->dmx.auto_size.is_enabled) {
+    size = driver->dmx.staged.size;
+    if (size < DMX_PACKET_SIZE_AUTO_MIN) {
+      size = DMX_PACKET_SIZE_AUTO_MIN;
+    }
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return dmx_send_num(dmx_num, size);
+}
+
+size_t dmx_send_async(dmx_port_t dmx_num, size_t size, dmx_send_cb_t callback,
+                      void *context) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+  DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
+  DMX_CHECK(!dmx_continuous_is_enabled(dmx_num), 0,
+            "continuous mode is enabled");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Return early if the mutex can't be taken
+  if (!xSemaphoreTakeRecursive(driver->mux, 0)) {
+    return 0;
+  }
+
+  // Don't block if the previous packet is still being sent
+  bool is_sending;
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  is_sending = driver->dmx.status == DMX_STATUS_SENDING;
+  if (!is_sending) {
+    driver->dmx.send_cb.callback = callback;
+    driver->dmx.send_cb.context = context;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (is_sending) {
+    xSemaphoreGiveRecursive(driver->mux);
+    return 0;
+  }
+
+  size = dmx_send_packet(dmx_num, size, false);
+  if (size == 0) {
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    driver->dmx.send_cb.callback = NULL;  // The packet wasn't sent
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  }
+
+  xSemaphoreGiveRecursive(driver->mux);
+  return size;
+}
+
+bool dmx_auto_size_enable(dmx_port_t dmx_num, uint32_t break_to_break_us) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  // The DMX standard does not allow DMX breaks to be closer than this
+  if (break_to_break_us < DMX_BREAK_TO_BREAK_MIN_US) {
+    break_to_break_us = DMX_BREAK_TO_BREAK_MIN_US;
+  }
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.auto_size.is_enabled = true;
+  driver->dmx.auto_size.break_to_break = break_to_break_us;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return true;
+}
+
+bool dmx_auto_size_disable(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  dmx_driver[dmx_num]->dmx.auto_size.is_enabled = false;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return true;
+}
+
+size_t dmx_send_group(const dmx_port_t *dmx_nums, size_t num, size_t size,
+                      uint32_t *skew_us) {
+  DMX_CHECK(dmx_nums, 0, "dmx_nums is null");
+  DMX_CHECK(num > 0 && num <= DMX_NUM_MAX, 0, "num error");
+  DMX_CHECK(size <= DMX_PACKET_SIZE_MAX, 0, "size error");
+  for (int i = 0; i < num; ++i) {
+    const dmx_port_t dmx_num = dmx_nums[i];
+    DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+    DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+    DMX_CHECK(dmx_driver_is_enabled(dmx_num), 0, "driver is not enabled");
+    DMX_CHECK(!dmx_continuous_is_enabled(dmx_num), 0,
+              "continuous mode is enabled");
+    for (int j = 0; j < i; ++j) {
+      DMX_CHECK(dmx_nums[j] != dmx_num, 0, "dmx_nums error");
+    }
+  }
+
+  if (size == 0) {
+    size = DMX_PACKET_SIZE_MAX;
+  }
+
+  // Sort the ports so that concurrent calls take their locks in the same order
+  dmx_port_t ports[DMX_NUM_MAX];
+  for (int i = 0; i < num; ++i) {
+    int j = i;
+    for (; j > 0 && ports[j - 1] > dmx_nums[i]; --j) {
+      ports[j] = ports[j - 1];
+    }
+    ports[j] = dmx_nums[i];
+  }
+
+  // Block until every mutex is taken and every driver is done sending
+  int taken = 0;
+  for (; taken < num; ++taken) {
+    const dmx_port_t dmx_num = ports[taken];
+    if (!xSemaphoreTakeRecursive(dmx_driver[dmx_num]->mux, 0)) {
+      break;
+    } else if (!dmx_wait_sent(dmx_num, dmx_ms_to_ticks(23))) {
+      xSemaphoreGiveRecursive(dmx_driver[dmx_num]->mux);
+      break;
+    }
+  }
+  if (taken < num) {
+    while (taken > 0) {
+      xSemaphoreGiveRecursive(dmx_driver[ports[--taken]]->mux);
+    }
+    return 0;
+  }
+
+  // Prepare each port to send a DMX packet as the DMX controller
+  int64_t break_time =
+      dmx_timer_get_micros_since_boot() + DMX_GROUP_ALARM_LEAD_US;
+  for (int i = 0; i < num; ++i) {
+    const dmx_port_t dmx_num = ports[i];
+    dmx_driver_t *const driver = dmx_driver[dmx_num];
+    driver->is_controller = true;
+    dmx_staged_update(dmx_num);
+    dmx_staged_publish(dmx_num);
+    const int64_t spacing = dmx_get_packet_spacing(dmx_num);
+
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    if (dmx_uart_get_rts(dmx_num) == 1) {
+      dmx_uart_set_rts(dmx_num, 0);
+    }
+    driver->dmx.size = size;
+    driver->dmx.last_controller_pid = 0;
+    driver->dmx.last_request_was_broadcast = false;
+    driver->dmx.responder_sent_last = false;
+    const int64_t earliest = driver->dmx.controller_eop_timestamp + spacing;
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+    // The DMX breaks can't start until every port has waited its spacing
+    if (earliest > break_time) {
+      break_time = earliest;
+    }
+  }
+
+  /* Arm the timer of every port to expire at the same point in time. The timer
+  ISR of each port starts its DMX break and records its break timestamp. The
+  ports don't share a hardware timer, so the alignment is best-effort: the skew
+  between the DMX breaks is the difference in the latency of the timer ISRs.*/
+  for (int i = 0; i < num; ++i) {
+    taskENTER_CRITICAL(DMX_SPINLOCK(ports[i]));
+  }
+  for (int i = 0; i < num; ++i) {
+    const dmx_port_t dmx_num = ports[i];
+    dmx_driver_t *const driver = dmx_driver[dmx_num];
+    const int64_t now = dmx_timer_get_micros_since_boot();
+    driver->dmx.head = 0;
+    driver->dmx.progress = DMX_PROGRESS_IN_SPACING;
+    driver->dmx.status = DMX_STATUS_SENDING;
+    dmx_timer_set_counter(dmx_num, 0);
+    const int64_t alarm = break_time > now ? break_time - now : 1;
+    dmx_timer_set_alarm(dmx_num, alarm, false);
+    dmx_timer_start(dmx_num);
+  }
+  for (int i = num - 1; i >= 0; --i) {
+    taskEXIT_CRITICAL(DMX_SPINLOCK(ports[i]));
+  }
+
+  // Report the skew between the break timestamps recorded by the timer ISRs
+  if (skew_us != NULL) {
+    int64_t first_break = INT64_MAX;
+    int64_t last_break = INT64_MIN;
+    for (int i = 0; i < num; ++i) {
+      const dmx_port_t dmx_num = ports[i];
+      dmx_wait_sent(dmx_num, dmx_ms_to_ticks(23));
+      taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+      const int64_t break_timestamp = dmx_driver[dmx_num]->dmx.break_timestamp;
+      taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+      if (break_timestamp < first_break) {
+        first_break = break_timestamp;
+      }
+      if (break_timestamp > last_break) {
+        last_break = break_timestamp;
+      }
+    }
+    *skew_us = last_break - first_break;
+  }
+
+  // Give the mutexes back
+  for (int i = num - 1; i >= 0; --i) {
+    xSemaphoreGiveRecursive(dmx_driver[ports[i]]->mux);
+  }
+  return size;
+}
+
+bool dmx_continuous_enable(dmx_port_t dmx_num, size_t size,
+                           uint32_t period_us) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(size <= DMX_PACKET_SIZE_MAX, false, "size error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+  DMX_CHECK(dmx_driver_is_enabled(dmx_num), false, "driver is not enabled");
+  DMX_CHECK(!dmx_continuous_is_enabled(dmx_num), false,
+            "continuous mode is already enabled");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Block until the mutex can be taken
+  if (!xSemaphoreTakeRecursive(driver->mux, 0)) {
+    return false;
+  }
+
+  // Block until the driver is done sending
+  if (!dmx_wait_sent(dmx_num, dmx_ms_to_ticks(23))) {
+    xSemaphoreGiveRecursive(driver->mux);
+    return false;
+  }
+
+  /* Fades are only evaluated by dmx_send(), so they would stall in continuous
+  mode. The fade engine is held until continuous mode is enabled so that a fade
+  can't be started in the meantime.*/
+  const dmx_fade_t *const fade = dmx_fade_take(dmx_num);
+  if (fade != NULL && fade->start < fade->end) {
+    dmx_fade_give(dmx_num);
+    xSemaphoreGiveRecursive(driver->mux);
+    DMX_CHECK(false, false, "a fade is active");
+  }
+
+  // Merges are also only evaluated by dmx_send(), so hold the merge engine too
+  const dmx_merge_t *const merge = dmx_merge_take(dmx_num);
+  if (merge != NULL && merge->active != 0) {
+    dmx_merge_give(dmx_num);
+    dmx_fade_give(dmx_num);
+    xSemaphoreGiveRecursive(driver->mux);
+    DMX_CHECK(false, false, "a merge source is active");
+  }
+
+  if (size == 0) {
+    size = DMX_PACKET_SIZE_MAX;
+  }
+
+  // The DMX standard does not allow DMX breaks to be closer than this
+  if (period_us < DMX_BREAK_TO_BREAK_MIN_US) {
+    period_us = DMX_BREAK_TO_BREAK_MIN_US;
+  }
+
+  // Publish DMX data which was written before continuous mode was enabled
+  dmx_staged_publish(dmx_num);
+
+  /* The ISR swaps in the whole staged buffer in continuous mode, so the slots
+  which haven't been written must match the DMX buffer.*/
+  dmx_staged_begin_write(dmx_num);
+  dmx_staged_sync(driver, driver->dmx.data);
+  dmx_staged_end_write(dmx_num, false);
+
+  // Flip the DMX bus to write mode
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (dmx_uart_get_rts(dmx_num) == 1) {
+    dmx_uart_set_rts(dmx_num, 0);
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  // Record that this device is the DMX controller and send the first packet
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->is_controller = true;
+  driver->dmx.last_controller_pid = 0;
+  driver->dmx.last_request_was_broadcast = false;
+  driver->dmx.responder_sent_last = false;
+  driver->dmx.continuous.is_enabled = true;
+  driver->dmx.continuous.size = size;
+  driver->dmx.continuous.period = period_us;
+  driver->dmx.break_timestamp = dmx_timer_get_micros_since_boot();
+  driver->dmx.size = size;
+  driver->dmx.head = 0;
+  driver->dmx.progress = DMX_PROGRESS_IN_BREAK;
+  driver->dmx.status = DMX_STATUS_SENDING;
+  dmx_timer_set_counter(dmx_num, 0);
+  dmx_timer_set_alarm(dmx_num, driver->break_len, true);
+  dmx_timer_start(dmx_num);
+  dmx_uart_invert_tx(dmx_num, 1);
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  // Give the mutexes back
+  dmx_merge_give(dmx_num);
+  dmx_fade_give(dmx_num);
+  xSemaphoreGiveRecursive(driver->mux);
+  return true;
+}
+
+bool dmx_continuous_disable(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), false, "driver is not installed");
+  DMX_CHECK(dmx_continuous_is_enabled(dmx_num), false,
+            "continuous mode is not enabled");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  // Stop scheduling packets, but allow the current packet to finish
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.continuous.is_enabled = false;
+  if (driver->dmx.status != DMX_STATUS_SENDING) {
+    dmx_timer_stop(dmx_num);  // Cancel the alarm for the next packet
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return true;
+}
+
+bool dmx_continuous_is_enabled(dmx_port_t dmx_num) {
+  bool is_enabled;
+  if (dmx_driver_is_installed(dmx_num)) {
+    taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+    is_enabled = dmx_driver[dmx_num]->dmx.continuous.is_enabled;
+    taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+  } else {
+    is_enabled = false;
+  }
+
+  return is_enabled;
 }
 
 bool dmx_wait_sent(dmx_port_t dmx_num, TickType_t wait_ticks) {
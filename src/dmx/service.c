@@ -109,3 +109,16 @@ dmx_parameter_t *dmx_parameter_get_entry(dmx_port_t dmx_num,
 
   return NULL;  // Parameter does not exist
 }
+
+void dmx_buffer_detach_frame(dmx_port_t dmx_num) {
+  assert(dmx_num < DMX_NUM_MAX);
+  assert(dmx_driver_is_installed(dmx_num));
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  if (driver->dmx.data == driver->dmx.frame.data) {
+    driver->dmx.data = dmx_buffer_get_spare(driver);
+    driver->dmx.checksum_len = 0;
+    ++driver->dmx.generation;
+  }
+}
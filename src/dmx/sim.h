@@ -0,0 +1,156 @@
+/**
+ * @file dmx/sim.h
+ * @author Mitch Weisbrod (mitch@theweisbrods.com)
+ * @brief This file contains functions to configure and inspect the virtual
+ * RS-485 bus that is used when esp_dmx is built for the ESP-IDF linux target.
+ * Every DMX port on the host is connected to the same virtual bus. The virtual
+ * bus runs on its own clock which only advances when there is activity on the
+ * bus, so timing results are deterministic and independent of the speed of the
+ * host machine. Emulated RDM responders may be added to the virtual bus to test
+ * RDM controllers against large RDM networks.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dmx/include/types.h"
+#include "rdm/include/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Statistics that are gathered by the virtual bus for each DMX port.*/
+typedef struct dmx_sim_stats_t {
+  /** @brief The number of times that the UART ISR was called.*/
+  uint32_t uart_isr_count;
+  /** @brief The number of times that the timer ISR was called.*/
+  uint32_t timer_isr_count;
+  /** @brief The number of times that the DMX sniffer GPIO ISR was called.*/
+  uint32_t gpio_isr_count;
+  /** @brief The number of slots that were shifted out by the UART.*/
+  uint32_t slots_sent;
+  /** @brief The number of slots that were received by the UART.*/
+  uint32_t slots_received;
+  /** @brief The number of DMX breaks that were detected by the UART.*/
+  uint32_t breaks_received;
+  /** @brief The number of slots that were lost due to a full RX FIFO.*/
+  uint32_t rx_overflows;
+  /** @brief The number of slots that were received with a framing error.*/
+  uint32_t framing_errors;
+  /** @brief The number of received slots which were driven by more than one
+     transmitter at the same time.*/
+  uint32_t collisions;
+} dmx_sim_stats_t;
+
+/** @brief Statistics that are gathered by the emulated RDM responders of the
+ * virtual bus.*/
+typedef struct dmx_sim_rdm_stats_t {
+  /** @brief The number of valid RDM requests that were received.*/
+  uint32_t requests;
+  /** @brief The number of RDM_PID_DISC_UNIQUE_BRANCH requests that were
+     received.*/
+  uint32_t disc_unique_branch;
+  /** @brief The number of RDM_PID_DISC_MUTE requests that were received.*/
+  uint32_t disc_mute;
+  /** @brief The number of RDM_PID_DISC_UN_MUTE requests that were received.*/
+  uint32_t disc_un_mute;
+  /** @brief The number of responses that were sent by the emulated
+     responders. Simultaneous responses are counted once.*/
+  uint32_t responses;
+  /** @brief The number of responses that were sent by more than one emulated
+     responder at the same time.*/
+  uint32_t collisions;
+} dmx_sim_rdm_stats_t;
+
+/**
+ * @brief Sets the time it takes for the RS-485 transceiver of a DMX port to
+ * begin driving the DMX bus after the port switches from reading to writing.
+ * The default value is 0.
+ *
+ * @param turnaround_us The turnaround time in microseconds.
+ */
+void dmx_sim_set_turnaround(uint32_t turnaround_us);
+
+/**
+ * @brief Gets the virtual time of the DMX bus.
+ *
+ * @return The number of microseconds that have elapsed on the virtual bus.
+ */
+int64_t dmx_sim_get_time(void);
+
+/**
+ * @brief Gets the statistics that were gathered for a DMX port.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] stats A pointer to a struct into which to copy the statistics.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_sim_get_stats(dmx_port_t dmx_num, dmx_sim_stats_t *stats);
+
+/**
+ * @brief Resets the statistics that were gathered for a DMX port.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_sim_reset_stats(dmx_port_t dmx_num);
+
+/**
+ * @brief Adds emulated RDM responders to the virtual bus. Emulated responders
+ * are not DMX ports; they listen to every RDM request on the virtual bus and
+ * respond to RDM discovery requests with the discovery handler of the esp_dmx
+ * responder. Requests for any other parameter are answered with
+ * RDM_NR_UNKNOWN_PID. Responders which are targeted by the same request
+ * respond at the same time so that their responses collide on the bus.
+ *
+ * @param[in] uids An array of UIDs of the responders to add.
+ * @param num The number of UIDs in the array.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_sim_add_responders(const rdm_uid_t *uids, size_t num);
+
+/**
+ * @brief Removes every emulated RDM responder from the virtual bus.
+ */
+void dmx_sim_remove_responders(void);
+
+/**
+ * @brief Gets the number of emulated RDM responders on the virtual bus.
+ *
+ * @return The number of emulated RDM responders.
+ */
+size_t dmx_sim_get_responder_count(void);
+
+/**
+ * @brief Sets the time it takes for emulated RDM responders to respond to an
+ * RDM request. The default value is RDM_TIMING_RESPONDER_MIN, 176 microseconds.
+ *
+ * @param response_time_us The response time in microseconds.
+ */
+void dmx_sim_set_response_time(uint32_t response_time_us);
+
+/**
+ * @brief Gets the statistics that were gathered by the emulated RDM
+ * responders.
+ *
+ * @param[out] stats A pointer to a struct into which to copy the statistics.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_sim_get_rdm_stats(dmx_sim_rdm_stats_t *stats);
+
+/**
+ * @brief Resets the statistics that were gathered by the emulated RDM
+ * responders.
+ */
+void dmx_sim_reset_rdm_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
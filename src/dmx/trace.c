@@ -0,0 +1,150 @@
+#include "dmx/trace.h"
+
+#include <stdio.h>
+
+#include "dmx/hal/include/timer.h"
+#include "dmx/include/service.h"
+
+#if CONFIG_DMX_TRACE_SIZE > 0
+static struct dmx_trace_t {
+  uint32_t head;  // The index of the next event to be recorded.
+  uint32_t tail;  // The index of the first event since the trace was cleared.
+  struct dmx_trace_entry_t {
+    uint32_t seq;  // The index of the event plus one, or 0 while it's written.
+    dmx_trace_event_t event;
+  } entries[CONFIG_DMX_TRACE_SIZE];
+} dmx_trace_context[DMX_NUM_MAX];
+#endif
+
+void DMX_ISR_ATTR dmx_trace_record(dmx_port_t dmx_num, dmx_trace_type_t type,
+                                   int32_t arg) {
+#if CONFIG_DMX_TRACE_SIZE > 0
+  struct dmx_trace_t *const trace = &dmx_trace_context[dmx_num];
+  const int64_t now = dmx_timer_get_micros_since_boot();
+
+  // Reserve an entry so that concurrent writers never share an entry
+  const uint32_t i = __atomic_fetch_add(&trace->head, 1, __ATOMIC_RELAXED);
+  struct dmx_trace_entry_t *const entry =
+      &trace->entries[i % CONFIG_DMX_TRACE_SIZE];
+
+  // Invalidate the entry while the event is written
+  __atomic_store_n(&entry->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  entry->event.timestamp = now;
+  entry->event.type = type;
+  entry->event.arg = arg;
+  __atomic_store_n(&entry->seq, i + 1, __ATOMIC_RELEASE);
+#endif
+}
+
+#if CONFIG_DMX_TRACE_SIZE > 0
+static uint32_t dmx_trace_get_first(struct dmx_trace_t *trace, uint32_t head,
+                                    size_t size) {
+  // Only the most recent events which have not been overwritten are valid
+  uint32_t first = __atomic_load_n(&trace->tail, __ATOMIC_RELAXED);
+  if (head - first > CONFIG_DMX_TRACE_SIZE) {
+    first = head - CONFIG_DMX_TRACE_SIZE;
+  }
+  if (head - first > size) {
+    first = head - size;
+  }
+  return first;
+}
+
+static bool dmx_trace_get_event(struct dmx_trace_t *trace, uint32_t i,
+                                dmx_trace_event_t *event) {
+  const struct dmx_trace_entry_t *const entry =
+      &trace->entries[i % CONFIG_DMX_TRACE_SIZE];
+  const uint32_t seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+  *event = entry->event;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+  // The event is invalid if it is being written or if it was overwritten
+  return seq == i + 1 && __atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == seq;
+}
+#endif
+
+size_t dmx_trace_read(dmx_port_t dmx_num, dmx_trace_event_t *events,
+                      size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(events != NULL || size == 0, 0, "events is null");
+
+  size_t count = 0;
+#if CONFIG_DMX_TRACE_SIZE > 0
+  struct dmx_trace_t *const trace = &dmx_trace_context[dmx_num];
+  const uint32_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+  for (uint32_t i = dmx_trace_get_first(trace, head, size); i != head; ++i) {
+    if (dmx_trace_get_event(trace, i, &events[count])) {
+      ++count;
+    }
+  }
+#endif
+
+  return count;
+}
+
+bool dmx_trace_clear(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+
+#if CONFIG_DMX_TRACE_SIZE > 0
+  struct dmx_trace_t *const trace = &dmx_trace_context[dmx_num];
+  const uint32_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&trace->tail, head, __ATOMIC_RELAXED);
+#endif
+
+  return true;
+}
+
+const char *dmx_trace_type_to_str(dmx_trace_type_t type) {
+  switch (type) {
+    case DMX_TRACE_RX_BREAK:
+      return "rx break";
+    case DMX_TRACE_RX_PACKET:
+      return "rx packet";
+    case DMX_TRACE_TX_DONE:
+      return "tx done";
+    case DMX_TRACE_RTS:
+      return "rts";
+    case DMX_TRACE_TIMER_ALARM:
+      return "timer alarm";
+    case DMX_TRACE_NOTIFY:
+      return "notify";
+    case DMX_TRACE_SEND:
+      return "send";
+    case DMX_TRACE_SEND_TOO_LATE:
+      return "send too late";
+    case DMX_TRACE_RECEIVE_WAIT:
+      return "receive wait";
+    case DMX_TRACE_RECEIVE_WOKEN:
+      return "receive woken";
+    case DMX_TRACE_RDM_RESPONSE:
+      return "rdm response";
+    default:
+      return "unknown";
+  }
+}
+
+bool dmx_trace_print(dmx_port_t dmx_num) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, false, "dmx_num error");
+
+#if CONFIG_DMX_TRACE_SIZE > 0
+  struct dmx_trace_t *const trace = &dmx_trace_context[dmx_num];
+  const uint32_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+  int64_t last_timestamp = -1;
+  for (uint32_t i = dmx_trace_get_first(trace, head, CONFIG_DMX_TRACE_SIZE);
+       i != head; ++i) {
+    dmx_trace_event_t event;
+    if (!dmx_trace_get_event(trace, i, &event)) {
+      continue;
+    }
+    const int64_t elapsed =
+        last_timestamp >= 0 ? event.timestamp - last_timestamp : 0;
+    last_timestamp = event.timestamp;
+    printf("%12lli us %+8lli us  %-14s %li\n", (long long)event.timestamp,
+           (long long)elapsed, dmx_trace_type_to_str(event.type),
+           (long)event.arg);
+  }
+#endif
+
+  return true;
+}
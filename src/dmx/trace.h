@@ -0,0 +1,122 @@
+/**
+ * @file dmx/trace.h
+ * @author Mitch Weisbrod (mitch@theweisbrods.com)
+ * @brief This file contains functions to read the DMX driver event trace. When
+ * CONFIG_DMX_TRACE_SIZE is greater than zero, each DMX port records the most
+ * recent events of its interrupt handlers and of the functions which send and
+ * receive packets into a ring buffer. Each event is timestamped so that the
+ * time spent between a received packet, the task that handles it, and the
+ * packet that is sent in response can be measured. Events are recorded without
+ * taking a lock so that tracing can be used in interrupt handlers.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dmx/include/types.h"
+
+#ifndef CONFIG_DMX_TRACE_SIZE
+/* The number of driver events that are recorded for each DMX port. Setting
+ * this value to 0 disables the driver event trace.*/
+#define CONFIG_DMX_TRACE_SIZE (0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief The types of events that are recorded by the DMX driver event trace.
+ * The meaning of the argument of each event is described by its comment.*/
+typedef enum dmx_trace_type_t {
+  DMX_TRACE_RX_BREAK,       // A DMX break was received. No argument.
+  DMX_TRACE_RX_PACKET,      // A packet was received. The number of slots.
+  DMX_TRACE_TX_DONE,        // A packet was sent. The number of slots.
+  DMX_TRACE_RTS,            // The RTS pin was set. The level of the pin.
+  DMX_TRACE_TIMER_ALARM,    // The timer ISR was called. The packet progress.
+  DMX_TRACE_NOTIFY,         // A waiting task was notified. The dmx_err_t.
+  DMX_TRACE_SEND,           // A packet send was started. The number of slots.
+  DMX_TRACE_SEND_TOO_LATE,  // A response wasn't sent. Microseconds elapsed.
+  DMX_TRACE_RECEIVE_WAIT,   // A task began to wait. The number of slots.
+  DMX_TRACE_RECEIVE_WOKEN,  // A waiting task was woken. The dmx_err_t.
+  DMX_TRACE_RDM_RESPONSE,   // An RDM response was handled. The RDM PID.
+} dmx_trace_type_t;
+
+/** @brief An event which was recorded by the DMX driver event trace.*/
+typedef struct dmx_trace_event_t {
+  /** @brief The time in microseconds since boot at which the event occurred.*/
+  int64_t timestamp;
+  /** @brief The type of the event.*/
+  dmx_trace_type_t type;
+  /** @brief The argument of the event. Its meaning depends on the type.*/
+  int32_t arg;
+} dmx_trace_event_t;
+
+/**
+ * @brief Records an event in the DMX driver event trace. This is called by the
+ * DMX driver and may be called from interrupt handlers.
+ *
+ * @param dmx_num The DMX port number.
+ * @param type The type of the event.
+ * @param arg The argument of the event.
+ */
+void dmx_trace_record(dmx_port_t dmx_num, dmx_trace_type_t type, int32_t arg);
+
+#if CONFIG_DMX_TRACE_SIZE > 0
+/** @brief Records an event in the DMX driver event trace.*/
+#define DMX_TRACE(dmx_num, type, arg) dmx_trace_record(dmx_num, type, arg)
+#else
+/** @brief Records an event in the DMX driver event trace. The trace is
+ * disabled so no event is recorded.*/
+#define DMX_TRACE(dmx_num, type, arg) \
+  do {                                \
+  } while (0)
+#endif
+
+/**
+ * @brief Copies the most recent events of the DMX driver event trace, oldest
+ * first. Events which were recorded before the trace was last cleared are not
+ * copied.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[out] events An array into which to copy the events.
+ * @param size The maximum number of events to copy.
+ * @return The number of events that were copied. Always 0 when
+ * CONFIG_DMX_TRACE_SIZE is 0.
+ */
+size_t dmx_trace_read(dmx_port_t dmx_num, dmx_trace_event_t *events,
+                      size_t size);
+
+/**
+ * @brief Discards the events which have been recorded by the DMX driver event
+ * trace.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_trace_clear(dmx_port_t dmx_num);
+
+/**
+ * @brief Gets a string which describes the type of a DMX driver event.
+ *
+ * @param type The type of the event.
+ * @return A string which describes the type of the event.
+ */
+const char *dmx_trace_type_to_str(dmx_trace_type_t type);
+
+/**
+ * @brief Prints the events of the DMX driver event trace, oldest first. Each
+ * line contains the timestamp of the event, the number of microseconds since
+ * the previous event, the type of the event, and its argument.
+ *
+ * @param dmx_num The DMX port number.
+ * @return true on success.
+ * @return false on failure.
+ */
+bool dmx_trace_print(dmx_port_t dmx_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -30,11 +30,17 @@ extern "C" {
   ((ESP_DMX_VERSION_MAJOR << 16) | (ESP_DMX_VERSION_MINOR << 8) | \
    ESP_DMX_VERSION_PATCH)
 
+/** @brief Converts a macro argument into a string literal.*/
+#define DMX_STR(x) #x
+
+/** @brief Expands a macro argument and converts it into a string literal.*/
+#define DMX_XSTR(x) DMX_STR(x)
+
 /** @brief The version of this library expressed as a string value.*/
-#define ESP_DMX_VERSION_LABEL                         \
-  __XSTRING(ESP_DMX_VERSION_MAJOR)                    \
-  "." __XSTRING(ESP_DMX_VERSION_MINOR) "." __XSTRING( \
-      ESP_DMX_VERSION_PATCH) " " __DATE__
+#define ESP_DMX_VERSION_LABEL                                             \
+  DMX_XSTR(ESP_DMX_VERSION_MAJOR)                                         \
+  "." DMX_XSTR(ESP_DMX_VERSION_MINOR) "." DMX_XSTR(ESP_DMX_VERSION_PATCH) \
+  " " __DATE__
 
 #if defined(CONFIG_DMX_ISR_IN_IRAM) || ESP_IDF_VERSION_MAJOR < 5
 /** @brief The default interrupt flags for the DMX driver. Places the
@@ -56,6 +62,7 @@ extern "C" {
         ESP_DMX_VERSION_ID,           /*software_version_id*/         \
         ESP_DMX_VERSION_LABEL,        /*software_version_label*/      \
         32,                           /*queue_size_max*/              \
+        NULL,                         /*hal*/                         \
   }
 
 #ifdef __cplusplus
@@ -19,11 +19,9 @@ size_t rdm_send_request(dmx_port_t dmx_num, const rdm_request_t *request,
   assert(rdm_cc_is_valid(request->cc) && rdm_cc_is_request(request->cc));
   assert(request->sub_device != RDM_SUB_DEVICE_ALL ||
          request->cc == RDM_CC_SET_COMMAND);
-  assert(rdm_format_is_valid(request->format));
   assert(request->format != NULL || request->pd == NULL);
   assert(request->pd != NULL || request->pdl == 0);
   assert(request->pdl < RDM_PD_SIZE_MAX);
-  assert(rdm_format_is_valid(format));
   assert(dmx_driver_is_installed(dmx_num));
 
   dmx_driver_t *const driver = dmx_driver[dmx_num];
@@ -51,15 +49,11 @@ size_t rdm_send_request(dmx_port_t dmx_num, const rdm_request_t *request,
   memcpy(&header.dest_uid, request->dest_uid, sizeof(header.dest_uid));
   memcpy(&header.src_uid, rdm_uid_get(dmx_num), sizeof(header.src_uid));
 
-  // Copy the old data in the DMX buffer to a temporary buffer
-  uint8_t old_data[257];
-  const size_t packet_size = header.message_len + 2; 
-  dmx_read(dmx_num, old_data, packet_size);
-
-  // Write and send the RDM request
-  rdm_write(dmx_num, &header, request->format, request->pd);
-  if (!dmx_send(dmx_num)) {
-    dmx_write(dmx_num, old_data, packet_size);  // Write old data back
+  // Write and send the RDM request from the RDM buffer
+  if (!dmx_buffer_attach_rdm(dmx_num) ||
+      !rdm_write(dmx_num, &header, request->format, request->pd) ||
+      !dmx_send(dmx_num)) {
+    dmx_buffer_detach_rdm(dmx_num);
     xSemaphoreGiveRecursive(driver->mux);
     if (ack != NULL) {
       ack->err = DMX_OK;
@@ -77,7 +71,7 @@ size_t rdm_send_request(dmx_port_t dmx_num, const rdm_request_t *request,
   if (rdm_uid_is_broadcast(request->dest_uid) &&
       request->pid != RDM_PID_DISC_UNIQUE_BRANCH) {
     dmx_wait_sent(dmx_num, dmx_ms_to_ticks(23));
-    dmx_write(dmx_num, old_data, packet_size);  // Write old data back
+    dmx_buffer_detach_rdm(dmx_num);
     xSemaphoreGiveRecursive(driver->mux);
     if (ack != NULL) {
       ack->err = DMX_OK;
@@ -101,7 +95,7 @@ size_t rdm_send_request(dmx_port_t dmx_num, const rdm_request_t *request,
 
   // Return early if no response was received
   if (packet.size == 0) {
-    dmx_write(dmx_num, old_data, packet_size);  // Write old data back
+    dmx_buffer_detach_rdm(dmx_num);
     xSemaphoreGiveRecursive(driver->mux);
     if (ack != NULL) {
       ack->src_uid = (rdm_uid_t){0, 0};
@@ -115,7 +109,7 @@ size_t rdm_send_request(dmx_port_t dmx_num, const rdm_request_t *request,
 
   // Return early if the response checksum was invalid
   if (!rdm_read_header(dmx_num, &header)) {
-    dmx_write(dmx_num, old_data, packet_size);  // Write old data back
+    dmx_buffer_detach_rdm(dmx_num);
     xSemaphoreGiveRecursive(driver->mux);
     if (ack != NULL) {
       ack->src_uid = (rdm_uid_t){0, 0};
@@ -161,8 +155,8 @@ size_t rdm_send_request(dmx_port_t dmx_num, const rdm_request_t *request,
     ack->message_count = header.message_count;
   }
 
-  // Write the old data from before the request back into the DMX driver
-  dmx_write(dmx_num, old_data, packet_size);
+  // Send and receive DMX packets in the DMX buffer again
+  dmx_buffer_detach_rdm(dmx_num);
 
   // Give the mutex back and return the PDL or true on success
   xSemaphoreGiveRecursive(driver->mux);
@@ -10,135 +10,194 @@
 #include "rdm/include/driver.h"
 #include "rdm/include/uid.h"
 
+// The compiled form of the RDM header format string "xCCx01buubbbwbwb$"
+static const rdm_format_t rdm_header_format = {
+    .op_count = 9,
+    .is_terminated = true,
+    .ops = {{'x', RDM_SC},
+            {'x', RDM_SUB_SC},
+            {'b', 1},   // Message length
+            {'u', 2},   // Destination UID and source UID
+            {'b', 3},   // Transaction number, port ID, and message count
+            {'w', 1},   // Sub-device
+            {'b', 1},   // Command class
+            {'w', 1},   // Parameter ID
+            {'b', 1}}};  // Parameter data length
+
+static int rdm_format_hash(const char *format) {
+  const uint32_t hash = (uint32_t)(uintptr_t)format * 2654435761u;
+  return (hash >> 16) % RDM_FORMAT_CACHE_SIZE;
+}
+
+static const rdm_format_t *rdm_format_get(dmx_driver_t *driver,
+                                          const char *format,
+                                          rdm_format_t *compiled) {
+  // Formats which were added to the driver have already been compiled
+  if (format != NULL) {
+    const int hash = rdm_format_hash(format);
+    for (int i = 0; i < RDM_FORMAT_CACHE_SIZE; ++i) {
+      const struct dmx_driver_rdm_format_t *entry =
+          &driver->rdm.formats[(hash + i) % RDM_FORMAT_CACHE_SIZE];
+      const char *const string =
+          __atomic_load_n(&entry->string, __ATOMIC_ACQUIRE);
+      if (string == format) {
+        return &entry->format;
+      } else if (string == NULL) {
+        break;
+      }
+    }
+  }
+
+  return rdm_format_compile(format, compiled) ? compiled : NULL;
+}
+
+static void rdm_format_encode_uid(uint8_t *dest, const uint8_t *src) {
+  rdm_uid_t uid;
+  memcpy(&uid, src, sizeof(uid));
+  uid.man_id = bswap16(uid.man_id);
+  uid.dev_id = bswap32(uid.dev_id);
+  memcpy(dest, &uid, sizeof(uid));
+}
+
 static size_t rdm_format_encode(void *restrict dest,
-                                const char *restrict format,
+                                const rdm_format_t *restrict format,
                                 const void *restrict src, size_t src_size,
                                 bool encode_nulls) {
   assert(dest != NULL);
-  assert(rdm_format_is_valid(format));
+  assert(format != NULL);
   assert(src != NULL);
 
+  uint8_t *d = dest;
+  const uint8_t *s = src;
   size_t encoded = 0;
   while (src_size > 0) {
-    const char *f = format;
-    for (char c = *f; c != '\0'; c = *(++f)) {
-      // Skip whitespaces
-      if (c == ' ') {
-        continue;
-      }
-
-      // Check for terminator
-      if (c == '$') {
-        return encoded;
-      }
-
-      // Copy the token to the destination buffer
-      size_t token_size;
-      if (c >= 'A' && c <= 'Z') {
-        c += 'A';  // Convert token to lowercase
-      }
-      if (c == 'b') {
-        token_size = sizeof(uint8_t);
-        memcpy(dest, src, token_size);
-        // Don't need to swap endianness on single byte
+    for (int i = 0; i < format->op_count; ++i) {
+      const rdm_format_op_t *op = &format->ops[i];
+      if (op->token == 'b') {
+        // Don't need to swap endianness on single bytes
+        const size_t token_size = op->value < src_size ? op->value : src_size;
+        memcpy(d, s, token_size);
+        d += token_size;
+        s += token_size;
+        src_size -= token_size;
         encoded += token_size;
-      } else if (c == 'w') {
-        token_size = sizeof(uint16_t);
-        memcpy(dest, src, token_size);
-        *(uint16_t *)dest = bswap16(*(uint16_t *)dest);
-        encoded += token_size;
-      } else if (c == 'd') {
-        token_size = sizeof(uint32_t);
-        memcpy(dest, src, token_size);
-        *(uint32_t *)dest = bswap32(*(uint32_t *)dest);
-        encoded += token_size;
-      } else if (c == 'u' || c == 'v') {
-        token_size = sizeof(rdm_uid_t);
-        if (c == 'v' && (src_size < token_size || rdm_uid_is_null(src))) {
+        if (token_size < op->value) {
+          return encoded;  // The source buffer is exhausted
+        }
+      } else if (op->token == 'w') {
+        for (int j = 0; j < op->value; ++j) {
+          if (src_size < sizeof(uint16_t)) {
+            return encoded;
+          }
+          uint16_t word;
+          memcpy(&word, s, sizeof(word));
+          word = bswap16(word);
+          memcpy(d, &word, sizeof(word));
+          d += sizeof(word);
+          s += sizeof(word);
+          src_size -= sizeof(word);
+          encoded += sizeof(word);
+        }
+      } else if (op->token == 'd') {
+        for (int j = 0; j < op->value; ++j) {
+          if (src_size < sizeof(uint32_t)) {
+            return encoded;
+          }
+          uint32_t dword;
+          memcpy(&dword, s, sizeof(dword));
+          dword = bswap32(dword);
+          memcpy(d, &dword, sizeof(dword));
+          d += sizeof(dword);
+          s += sizeof(dword);
+          src_size -= sizeof(dword);
+          encoded += sizeof(dword);
+        }
+      } else if (op->token == 'u') {
+        for (int j = 0; j < op->value; ++j) {
+          if (src_size < sizeof(rdm_uid_t)) {
+            return encoded;
+          }
+          rdm_format_encode_uid(d, s);
+          d += sizeof(rdm_uid_t);
+          s += sizeof(rdm_uid_t);
+          src_size -= sizeof(rdm_uid_t);
+          encoded += sizeof(rdm_uid_t);
+        }
+      } else if (op->token == 'v') {
+        if (src_size < sizeof(rdm_uid_t) || rdm_uid_is_null((void *)s)) {
           // Handle condition where an optional UID was not provided
           if (encode_nulls) {
-            memset(dest, 0, token_size);
-            encoded += token_size;
+            memset(d, 0, sizeof(rdm_uid_t));
+            encoded += sizeof(rdm_uid_t);
           }
           return encoded;
         }
-        memcpy(dest, src, token_size);
-        rdm_uid_t *const uid = dest;
-        uid->man_id = bswap16(uid->man_id);
-        uid->dev_id = bswap32(uid->dev_id);
-        encoded += token_size;
-        if (c == 'v') {
-          return encoded;
-        }
-      } else if (c == 'a') {
-        token_size = strnlen(src, (src_size < 32 ? src_size : 32));
-        memcpy(dest, src, token_size);
+        rdm_format_encode_uid(d, s);
+        return encoded + sizeof(rdm_uid_t);
+      } else if (op->token == 'a') {
+        size_t token_size = strnlen((void *)s, (src_size < 32 ? src_size : 32));
+        memcpy(d, s, token_size);
         if (encode_nulls) {
           // Only null-terminate the string if desired by the caller
-          ((uint8_t *)dest)[token_size] = '\0';
+          d[token_size] = '\0';
           token_size += 1;
         }
-        encoded += token_size;
-        return encoded;
-      } else if (c == 'x') {
-        // Copy the hex literal format string to a null-terminated string
-        char str[3];
-        str[2] = '\0';
-        memcpy(str, (f + 1), 2);
-
-        // Get the hex literal as an integer and copy it to the destination
-        token_size = sizeof(uint8_t);
-        const uint8_t literal = (uint8_t)strtol(str, NULL, 16);
-        memcpy(dest, &literal, token_size);
-        encoded += token_size;
-        // Don't need to swap endianness on single byte
-        f += 2;  // Skip to the next token
+        return encoded + token_size;
+      } else if (op->token == 'x') {
+        // Literals are written regardless of the underlying value
+        *d = op->value;
+        d += sizeof(uint8_t);
+        s += sizeof(uint8_t);
+        src_size -= sizeof(uint8_t);
+        encoded += sizeof(uint8_t);
       } else {
-        __unreachable();  // Unknown symbol
+        __unreachable();  // Unknown token
       }
 
-      // Update cursor
-      dest += token_size;
-      src += token_size;
-      src_size -= token_size;
+      if (src_size == 0) {
+        return encoded;
+      }
+    }
+
+    if (format->is_terminated || format->op_count == 0) {
+      break;
     }
   }
 
   return encoded;
 }
 
-bool DMX_ISR_ATTR rdm_read_header(dmx_port_t dmx_num, rdm_header_t *header) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
-  DMX_CHECK(dmx_driver[dmx_num] != NULL, 0, "driver is not installed");
-
-  dmx_driver_t *const driver = dmx_driver[dmx_num];
-
-  const uint8_t *data = driver->dmx.data;
+static bool DMX_ISR_ATTR rdm_decode_header(const uint8_t *data,
+                                           int checksum_len,
+                                           uint16_t running_checksum,
+                                           rdm_header_t *header) {
   uint16_t checksum = 0;
 
   // Check if packet is standard RDM packet or RDM discovery response packet
   if (*(uint16_t *)data == (RDM_SC | (RDM_SUB_SC << 8))) {
-    // Verify checksum
+    // Verify checksum, using the running checksum if it covers the message
     const uint8_t message_len = data[2];
-    for (int i = 0; i < message_len; ++i) {
-      checksum += data[i];
+    if (checksum_len == message_len) {
+      checksum = running_checksum;
+    } else {
+      for (int i = 0; i < message_len; ++i) {
+        checksum += data[i];
+      }
     }
     if (checksum != bswap16(*(uint16_t *)(data + message_len))) {
       return false;
     }
 
     // Copy the header without function calls for IRAM ISR
-    if (header != NULL) {
-      for (int i = 0; i < sizeof(rdm_header_t); ++i) {
-        ((uint8_t *)header)[i] = data[i];
-      }
-      header->dest_uid.man_id = bswap16(header->dest_uid.man_id);
-      header->dest_uid.dev_id = bswap32(header->dest_uid.dev_id);
-      header->src_uid.man_id = bswap16(header->src_uid.man_id);
-      header->src_uid.dev_id = bswap32(header->src_uid.dev_id);
-      header->sub_device = bswap16(header->sub_device);
-      header->pid = bswap16(header->pid);
+    for (int i = 0; i < sizeof(rdm_header_t); ++i) {
+      ((uint8_t *)header)[i] = data[i];
     }
+    header->dest_uid.man_id = bswap16(header->dest_uid.man_id);
+    header->dest_uid.dev_id = bswap32(header->dest_uid.dev_id);
+    header->src_uid.man_id = bswap16(header->src_uid.man_id);
+    header->src_uid.dev_id = bswap32(header->src_uid.dev_id);
+    header->sub_device = bswap16(header->sub_device);
+    header->pid = bswap16(header->pid);
 
     return true;
   } else if (*data == RDM_PREAMBLE || *data == RDM_DELIMITER) {
@@ -160,30 +219,27 @@ bool DMX_ISR_ATTR rdm_read_header(dmx_port_t dmx_num, rdm_header_t *header) {
       return false;
     }
 
-    // Copy the header without function calls for IRAM ISR
-    if (header != NULL) {
-      // Decode the EUID
-      uint8_t euid_buf[6];
-      for (int i = 0, j = 0; i < sizeof(euid_buf); ++i, j += 2) {
-        euid_buf[i] = data[j] & data[j + 1];
-      }
+    // Decode the EUID
+    uint8_t euid_buf[6];
+    for (int i = 0, j = 0; i < sizeof(euid_buf); ++i, j += 2) {
+      euid_buf[i] = data[j] & data[j + 1];
+    }
 
-      for (int i = 0; i < sizeof(rdm_uid_t); ++i) {
-        ((uint8_t *)&header->src_uid)[i] = euid_buf[i];
-      }
-      header->message_len = preamble_len + 17;
-      header->dest_uid.man_id = RDM_UID_BROADCAST_ALL.man_id;
-      header->dest_uid.dev_id = RDM_UID_BROADCAST_ALL.dev_id;
-      header->src_uid.man_id = bswap16(header->src_uid.man_id);
-      header->src_uid.dev_id = bswap32(header->src_uid.dev_id);
-      header->tn = 0;
-      header->response_type = RDM_RESPONSE_TYPE_ACK;
-      header->message_count = 0;
-      header->sub_device = RDM_SUB_DEVICE_ROOT;
-      header->cc = RDM_CC_DISC_COMMAND_RESPONSE;
-      header->pid = RDM_PID_DISC_UNIQUE_BRANCH;
-      header->pdl = 0;
+    for (int i = 0; i < sizeof(rdm_uid_t); ++i) {
+      ((uint8_t *)&header->src_uid)[i] = euid_buf[i];
     }
+    header->message_len = preamble_len + 17;
+    header->dest_uid.man_id = RDM_UID_BROADCAST_ALL.man_id;
+    header->dest_uid.dev_id = RDM_UID_BROADCAST_ALL.dev_id;
+    header->src_uid.man_id = bswap16(header->src_uid.man_id);
+    header->src_uid.dev_id = bswap32(header->src_uid.dev_id);
+    header->tn = 0;
+    header->response_type = RDM_RESPONSE_TYPE_ACK;
+    header->message_count = 0;
+    header->sub_device = RDM_SUB_DEVICE_ROOT;
+    header->cc = RDM_CC_DISC_COMMAND_RESPONSE;
+    header->pid = RDM_PID_DISC_UNIQUE_BRANCH;
+    header->pdl = 0;
 
     return true;
   }
@@ -191,16 +247,11 @@ bool DMX_ISR_ATTR rdm_read_header(dmx_port_t dmx_num, rdm_header_t *header) {
   return false;
 }
 
-size_t rdm_read_pd(dmx_port_t dmx_num, const char *format, void *destination,
-                   size_t size) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
-  DMX_CHECK(rdm_format_is_valid(format), 0, "format is invalid");
-  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
-
-  dmx_driver_t *const driver = dmx_driver[dmx_num];
-
+static size_t rdm_decode_pd(const uint8_t *data,
+                            const rdm_format_t *pd_format, void *destination,
+                            size_t size) {
   // Guard against invalid PDL
-  const size_t pdl = driver->dmx.data[23];
+  const size_t pdl = data[23];
   if (pdl == 0 || pdl > 231) {
     return 0;
   }
@@ -209,38 +260,15 @@ size_t rdm_read_pd(dmx_port_t dmx_num, const char *format, void *destination,
   if (destination != NULL) {
     size = pdl < size ? pdl : size;
     const bool encode_nulls = true;
-    const uint8_t *pd = &driver->dmx.data[24];
-    rdm_format_encode(destination, format, pd, size, encode_nulls);
+    rdm_format_encode(destination, pd_format, &data[24], size, encode_nulls);
   }
 
   return pdl;
 }
 
-size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
-                 const char *format, const void *pd) {
-  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
-  DMX_CHECK(header != NULL, 0, "header is null");
-  DMX_CHECK(
-      header->message_len >= 24 && header->message_len == 24 + header->pdl, 0,
-      "header->message_len error");
-  DMX_CHECK(header->sub_device < RDM_SUB_DEVICE_MAX ||
-                header->sub_device == RDM_SUB_DEVICE_ALL,
-            0, "header->sub_device error");
-  DMX_CHECK(rdm_cc_is_valid(header->cc), 0, "header->cc error");
-  DMX_CHECK(header->pdl < 231, 0, "header->pdl error");
-  if (rdm_cc_is_request(header->cc)) {
-    DMX_CHECK(header->port_id > 0, 0, "header->port_id error");
-  } else {
-    DMX_CHECK(rdm_response_type_is_valid(header->response_type), 0,
-              "header->response_type error");
-  }
-  DMX_CHECK(rdm_format_is_valid(format), 0, "format is invalid");
-  DMX_CHECK(header->pdl == 0 || (format != NULL && pd != NULL), 0,
-            "pd or format is null");
-  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
-
-  dmx_driver_t *const driver = dmx_driver[dmx_num];
-
+static size_t rdm_encode(uint8_t *data, const rdm_header_t *header,
+                         const rdm_format_t *pd_format, const void *pd,
+                         uint16_t *running_checksum, int *checksum_len) {
   // Encode a standard RDM packet or a RDM_CC_DISC_COMMAND_RESPONSE packet
   size_t written;
   const bool encode_nulls = false;
@@ -248,9 +276,9 @@ size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
       header->pid == RDM_PID_DISC_UNIQUE_BRANCH) {
     // Encode the preamble bytes
     const size_t preamble_len = 7;
-    memset(driver->dmx.data, RDM_PREAMBLE, preamble_len);
-    driver->dmx.data[preamble_len] = RDM_DELIMITER;
-    uint8_t *data = &driver->dmx.data[preamble_len + 1];
+    memset(data, RDM_PREAMBLE, preamble_len);
+    data[preamble_len] = RDM_DELIMITER;
+    uint8_t *euid = &data[preamble_len + 1];
 
     // Encode the UID and calculate the checksum
     uint8_t uid[6];
@@ -258,38 +286,39 @@ size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
     ((rdm_uid_t *)uid)->dev_id = bswap32(header->src_uid.dev_id);
     uint16_t checksum = 0;
     for (int i = 0, j = 0; j < sizeof(rdm_uid_t); i += 2, ++j) {
-      data[i] = uid[j] | 0xaa;
-      data[i + 1] = uid[j] | 0x55;
+      euid[i] = uid[j] | 0xaa;
+      euid[i + 1] = uid[j] | 0x55;
       checksum += uid[j] + (0xaa | 0x55);
     }
 
     // Encode the checksum
     const int cs_offset = sizeof(rdm_uid_t) * 2;
-    data[cs_offset + 0] = (uint8_t)(checksum >> 8) | 0xaa;
-    data[cs_offset + 1] = (uint8_t)(checksum >> 8) | 0x55;
-    data[cs_offset + 2] = (uint8_t)(checksum) | 0xaa;
-    data[cs_offset + 3] = (uint8_t)(checksum) | 0x55;
-
-    // Update written size
+    euid[cs_offset + 0] = (uint8_t)(checksum >> 8) | 0xaa;
+    euid[cs_offset + 1] = (uint8_t)(checksum >> 8) | 0x55;
+    euid[cs_offset + 2] = (uint8_t)(checksum) | 0xaa;
+    euid[cs_offset + 3] = (uint8_t)(checksum) | 0x55;
+
+    // A discovery response has no running checksum
+    *running_checksum = 0;
+    *checksum_len = 0;
     written = preamble_len + 1 + 16;
   } else {
-    // Serialize the header and pd into the driver buffer
-    const char *header_format = "xCCx01buubbbwbwb";
-    rdm_format_encode(driver->dmx.data, header_format, header, sizeof(*header),
+    // Serialize the header and pd into the buffer
+    rdm_format_encode(data, &rdm_header_format, header, sizeof(*header),
                       encode_nulls);
     size_t message_len;
-    void *data = &driver->dmx.data[24];
+    uint8_t *pd_data = &data[24];
     if (pd != NULL && header->pdl > 0) {
       size_t pdl =
-          rdm_format_encode(data, format, pd, header->pdl, encode_nulls);
+          rdm_format_encode(pd_data, pd_format, pd, header->pdl, encode_nulls);
       if (header->pdl != pdl) {
         message_len = 24 + pdl;
-        driver->dmx.data[2] = message_len;  // Encode updated message_len
-        driver->dmx.data[23] = pdl;         // Encode updated pdl
+        data[2] = message_len;  // Encode updated message_len
+        data[23] = pdl;         // Encode updated pdl
       } else {
         message_len = header->message_len;
       }
-      data += pdl;
+      pd_data += pdl;
     } else {
       message_len = sizeof(rdm_header_t);
     }
@@ -297,10 +326,12 @@ size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
     // Calculate and serialize the checksum
     uint16_t checksum = RDM_SC + RDM_SUB_SC;
     for (int i = 2; i < message_len; ++i) {
-      checksum += driver->dmx.data[i];
+      checksum += data[i];
     }
+    *checksum_len = message_len;
+    *running_checksum = checksum;
     checksum = bswap16(checksum);
-    memcpy(data, &checksum, sizeof(checksum));
+    memcpy(pd_data, &checksum, sizeof(checksum));
 
     written = message_len + 2;
   }
@@ -308,7 +339,144 @@ size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
   return written;
 }
 
-bool rdm_format_is_valid(const char *format) {
+bool DMX_ISR_ATTR rdm_read_header(dmx_port_t dmx_num, rdm_header_t *header) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(dmx_driver[dmx_num] != NULL, 0, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+  struct dmx_driver_rdm_header_cache_t *const cache = &driver->rdm.header_cache;
+
+  // Only decode the header once each time the DMX buffer changes
+  if (cache->generation != driver->dmx.generation) {
+    cache->is_valid =
+        rdm_decode_header(driver->dmx.data, driver->dmx.checksum_len,
+                          driver->dmx.checksum, &cache->header);
+    cache->generation = driver->dmx.generation;
+  }
+
+  // Copy the header without function calls for IRAM ISR
+  if (cache->is_valid && header != NULL) {
+    for (int i = 0; i < sizeof(rdm_header_t); ++i) {
+      ((uint8_t *)header)[i] = ((uint8_t *)&cache->header)[i];
+    }
+  }
+
+  return cache->is_valid;
+}
+
+size_t rdm_read_pd(dmx_port_t dmx_num, const char *format, void *destination,
+                   size_t size) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  rdm_format_t compiled;
+  const rdm_format_t *pd_format = rdm_format_get(driver, format, &compiled);
+  DMX_CHECK(pd_format != NULL, 0, "format is invalid");
+
+  return rdm_decode_pd(driver->dmx.data, pd_format, destination, size);
+}
+
+size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
+                 const char *format, const void *pd) {
+  DMX_CHECK(dmx_num < DMX_NUM_MAX, 0, "dmx_num error");
+  DMX_CHECK(header != NULL, 0, "header is null");
+  DMX_CHECK(
+      header->message_len >= 24 && header->message_len == 24 + header->pdl, 0,
+      "header->message_len error");
+  DMX_CHECK(header->sub_device < RDM_SUB_DEVICE_MAX ||
+                header->sub_device == RDM_SUB_DEVICE_ALL,
+            0, "header->sub_device error");
+  DMX_CHECK(rdm_cc_is_valid(header->cc), 0, "header->cc error");
+  DMX_CHECK(header->pdl < 231, 0, "header->pdl error");
+  if (rdm_cc_is_request(header->cc)) {
+    DMX_CHECK(header->port_id > 0, 0, "header->port_id error");
+  } else {
+    DMX_CHECK(rdm_response_type_is_valid(header->response_type), 0,
+              "header->response_type error");
+  }
+  DMX_CHECK(header->pdl == 0 || (format != NULL && pd != NULL), 0,
+            "pd or format is null");
+  DMX_CHECK(dmx_driver_is_installed(dmx_num), 0, "driver is not installed");
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  rdm_format_t compiled;
+  const rdm_format_t *pd_format = rdm_format_get(driver, format, &compiled);
+  DMX_CHECK(pd_format != NULL, 0, "format is invalid");
+
+  /* Don't overwrite the last complete DMX frame or send staged DMX data. The
+  RDM buffer never holds DMX data so the staged buffer is kept for later.*/
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  if (driver->rdm.dmx_data == NULL) {
+    dmx_buffer_detach_frame(dmx_num);
+    driver->dmx.staged.is_pending = false;
+    driver->dmx.staged.dirty_start = 0;
+    driver->dmx.staged.dirty_end = 0;
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  // Encode the packet into the driver buffer
+  uint16_t running_checksum;
+  int checksum_len;
+  const size_t written = rdm_encode(driver->dmx.data, header, pd_format, pd,
+                                    &running_checksum, &checksum_len);
+
+  // Invalidate the cached header and keep the checksum for rdm_read_header()
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  driver->dmx.checksum = running_checksum;
+  driver->dmx.checksum_len = checksum_len;
+  ++driver->dmx.generation;
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return written;
+}
+
+bool rdm_packet_read_header(const void *data, rdm_header_t *header) {
+  DMX_CHECK(data != NULL, false, "data is null");
+  DMX_CHECK(header != NULL, false, "header is null");
+
+  const int checksum_len = 0;  // No running checksum outside of a driver
+  return rdm_decode_header(data, checksum_len, 0, header);
+}
+
+size_t rdm_packet_read_pd(const void *data, const char *format,
+                          void *destination, size_t size) {
+  DMX_CHECK(data != NULL, 0, "data is null");
+
+  rdm_format_t pd_format;
+  DMX_CHECK(rdm_format_compile(format, &pd_format), 0, "format is invalid");
+
+  return rdm_decode_pd(data, &pd_format, destination, size);
+}
+
+size_t rdm_packet_write(void *data, const rdm_header_t *header,
+                        const char *format, const void *pd) {
+  DMX_CHECK(data != NULL, 0, "data is null");
+  DMX_CHECK(header != NULL, 0, "header is null");
+  DMX_CHECK(
+      header->message_len >= 24 && header->message_len == 24 + header->pdl, 0,
+      "header->message_len error");
+  DMX_CHECK(rdm_cc_is_valid(header->cc), 0, "header->cc error");
+  DMX_CHECK(header->pdl < 231, 0, "header->pdl error");
+  DMX_CHECK(header->pdl == 0 || (format != NULL && pd != NULL), 0,
+            "pd or format is null");
+
+  rdm_format_t pd_format;
+  DMX_CHECK(rdm_format_compile(format, &pd_format), 0, "format is invalid");
+
+  uint16_t running_checksum;
+  int checksum_len;
+  return rdm_encode(data, header, &pd_format, pd, &running_checksum,
+                    &checksum_len);
+}
+
+bool rdm_format_compile(const char *format, rdm_format_t *compiled) {
+  assert(compiled != NULL);
+
+  compiled->op_count = 0;
+  compiled->is_terminated = true;
   if (format == NULL) {
     return true;
   }
@@ -324,40 +492,41 @@ bool rdm_format_is_valid(const char *format) {
 
     // Get the size of the current token
     size_t token_size;
+    uint8_t value = 1;
+    if (c >= 'A' && c <= 'Z') {
+      c += 'a' - 'A';  // Convert token to lowercase
+    }
     switch (c) {
       case 'b':
-      case 'B':
         token_size = sizeof(uint8_t);
         break;
       case 'w':
-      case 'W':
         token_size = sizeof(uint16_t);
         break;
       case 'd':
-      case 'D':
         token_size = sizeof(uint32_t);
         break;
       case 'u':
-      case 'U':
         token_size = sizeof(rdm_uid_t);
         break;
       case 'v':
-      case 'V':
         token_size = sizeof(rdm_uid_t);
         format_is_terminated = true;
         break;
       case 'x':
-      case 'X':
         token_size = sizeof(uint8_t);
+        value = 0;
         for (int i = 0; i < 2; ++i) {
-          c = *(++format);
-          if (!isxdigit(c)) {
+          const char h = *(++format);
+          if (!isxdigit((unsigned char)h)) {
             return false;  // Hex literals must be 2 characters wide
           }
+          value = (value << 4) | (isdigit((unsigned char)h)
+                                      ? h - '0'
+                                      : tolower((unsigned char)h) - 'a' + 10);
         }
         break;
       case 'a':
-      case 'A':
         token_size = 32;  // ASCII fields can be up to 32 bytes
         format_is_terminated = true;
         break;
@@ -375,6 +544,21 @@ bool rdm_format_is_valid(const char *format) {
       return false;  // Parameter size is too big
     }
 
+    // Add the token to the op list, combining consecutive tokens of a type
+    const int op_count = compiled->op_count;
+    if (c == '$') {
+      // The terminator is not an op
+    } else if (op_count > 0 && compiled->ops[op_count - 1].token == c &&
+               (c == 'b' || c == 'w' || c == 'd' || c == 'u')) {
+      ++compiled->ops[op_count - 1].value;
+    } else if (op_count < RDM_FORMAT_OPS_MAX) {
+      compiled->ops[op_count].token = c;
+      compiled->ops[op_count].value = value;
+      ++compiled->op_count;
+    } else {
+      return false;  // Too many ops
+    }
+
     // End loop if parameter is terminated
     if (format_is_terminated) {
       break;
@@ -386,10 +570,52 @@ bool rdm_format_is_valid(const char *format) {
     if (*format != '\0' && *format != '$') {
       return false;  // Invalid token after terminator
     }
-  } else {
-    // Get the maximum possible size if parameter is unterminated
-    parameter_size = 231 - (231 % parameter_size);
   }
+  compiled->is_terminated = format_is_terminated;
 
   return parameter_size > 0;
 }
+
+bool rdm_format_is_valid(const char *format) {
+  rdm_format_t compiled;
+  return rdm_format_compile(format, &compiled);
+}
+
+bool rdm_format_add(dmx_port_t dmx_num, const char *format) {
+  assert(dmx_num < DMX_NUM_MAX);
+  assert(dmx_driver_is_installed(dmx_num));
+
+  if (format == NULL) {
+    return true;  // Nothing to compile
+  }
+
+  dmx_driver_t *const driver = dmx_driver[dmx_num];
+
+  rdm_format_t compiled;
+  if (!rdm_format_compile(format, &compiled)) {
+    return false;
+  }
+
+  /* Find the format or an empty entry in the cache. Entries are looked up
+  without a lock, so the string is published after the compiled format with
+  release ordering. The spinlock serializes tasks which add formats.*/
+  bool is_added = false;
+  const int hash = rdm_format_hash(format);
+  taskENTER_CRITICAL(DMX_SPINLOCK(dmx_num));
+  for (int i = 0; i < RDM_FORMAT_CACHE_SIZE; ++i) {
+    struct dmx_driver_rdm_format_t *entry =
+        &driver->rdm.formats[(hash + i) % RDM_FORMAT_CACHE_SIZE];
+    if (entry->string == format) {
+      is_added = true;
+      break;
+    } else if (entry->string == NULL) {
+      entry->format = compiled;
+      __atomic_store_n(&entry->string, format, __ATOMIC_RELEASE);
+      is_added = true;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(DMX_SPINLOCK(dmx_num));
+
+  return is_added;  // False if the cache is full
+}
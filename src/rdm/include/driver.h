@@ -3,6 +3,38 @@
 #include "dmx/include/types.h"
 #include "rdm/include/types.h"
 
+/** @brief The maximum number of ops in a compiled RDM format string.*/
+#define RDM_FORMAT_OPS_MAX (16)
+
+#ifndef CONFIG_RDM_FORMAT_CACHE_SIZE
+/* The number of compiled RDM format strings that each DMX driver can store.*/
+#define CONFIG_RDM_FORMAT_CACHE_SIZE (32)
+#endif
+
+/** @brief The number of compiled RDM format strings that each DMX driver can
+ * store.*/
+#define RDM_FORMAT_CACHE_SIZE (CONFIG_RDM_FORMAT_CACHE_SIZE)
+
+/**
+ * @brief A single op of a compiled RDM format string. Consecutive 'b', 'w',
+ * 'd', and 'u' tokens are combined into a single op.
+ */
+typedef struct rdm_format_op_t {
+  char token;     // The lowercase format token.
+  uint8_t value;  // The number of consecutive tokens or the hex literal value.
+} rdm_format_op_t;
+
+/**
+ * @brief An RDM format string which has been compiled into a list of ops so
+ * that parameter data can be encoded or decoded without parsing the format
+ * string.
+ */
+typedef struct rdm_format_t {
+  uint8_t op_count;    // The number of ops in the compiled format.
+  bool is_terminated;  // False if the ops repeat to fill the parameter data.
+  rdm_format_op_t ops[RDM_FORMAT_OPS_MAX];  // The compiled ops.
+} rdm_format_t;
+
 /**
  * @brief Returns the 48-bit unique ID of the desired DMX port. The specified
  * DMX driver must be installed before calling this function.
@@ -14,10 +46,13 @@ const rdm_uid_t *rdm_uid_get(dmx_port_t dmx_num);
 
 /**
  * @brief Reads an RDM packet from the DMX driver buffer. Header information is
- * read into a header pointer so that it may be read by the caller.
+ * read into a header pointer so that it may be read by the caller. The header
+ * is decoded once each time the contents of the DMX driver buffer change and is
+ * cached for subsequent calls.
  *
  * @param dmx_num The DMX port number.
- * @param[out] header A pointer which stores RDM header information.
+ * @param[out] header A pointer which stores RDM header information. May be
+ * NULL.
  * @return true if the packet is a valid RDM packet.
  * @return false if the packet is not a valid RDM packet.
  */
@@ -124,6 +159,47 @@ size_t rdm_read_pd(dmx_port_t dmx_num, const char *format, void *destination,
 size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
                  const char *format, const void *pd);
 
+/**
+ * @brief Decodes the header of an RDM packet which is stored in a buffer
+ * instead of a DMX driver. Standard RDM packets and RDM discovery responses are
+ * decoded the same way as rdm_read_header().
+ *
+ * @param[in] data A pointer to the RDM packet.
+ * @param[out] header A pointer which stores RDM header information.
+ * @return true if the packet is a valid RDM packet.
+ * @return false if the packet is not a valid RDM packet.
+ */
+bool rdm_packet_read_header(const void *data, rdm_header_t *header);
+
+/**
+ * @brief Reads RDM parameter data from an RDM packet which is stored in a
+ * buffer instead of a DMX driver. See rdm_read_pd() for the format string
+ * syntax.
+ *
+ * @param[in] data A pointer to the RDM packet.
+ * @param[in] format The format string of the RDM parameter data.
+ * @param[out] destination A pointer to a destination buffer into which to copy
+ * parameter data.
+ * @param size The size of the destination buffer.
+ * @return The size of the RDM parameter data or 0 on error.
+ */
+size_t rdm_packet_read_pd(const void *data, const char *format,
+                          void *destination, size_t size);
+
+/**
+ * @brief Encodes an RDM packet into a buffer instead of a DMX driver. Packets
+ * are encoded the same way as rdm_write(). See rdm_write() for the format
+ * string syntax.
+ *
+ * @param[out] data A pointer to a buffer of at least 257 bytes.
+ * @param[in] header A pointer which stores RDM header information.
+ * @param[in] format The format string of the RDM parameter data.
+ * @param[in] pd A pointer which stores parameter data to be written.
+ * @return The size of the RDM packet that was written or 0 on error.
+ */
+size_t rdm_packet_write(void *data, const rdm_header_t *header,
+                        const char *format, const void *pd);
+
 /**
  * @brief Returns true if the RDM format string is valid.
  *
@@ -131,4 +207,30 @@ size_t rdm_write(dmx_port_t dmx_num, const rdm_header_t *header,
  * @return true if the RDM format string is valid.
  * @return false if it is not valid.
  */
-bool rdm_format_is_valid(const char *format);
\ No newline at end of file
+bool rdm_format_is_valid(const char *format);
+
+/**
+ * @brief Compiles an RDM format string into a list of ops. A NULL format
+ * string compiles to an empty list of ops.
+ *
+ * @param[in] format The RDM format string.
+ * @param[out] compiled A pointer into which to write the compiled format.
+ * @return true if the RDM format string is valid.
+ * @return false if it is not valid.
+ */
+bool rdm_format_compile(const char *format, rdm_format_t *compiled);
+
+/**
+ * @brief Compiles an RDM format string and stores it in the DMX driver.
+ * rdm_write() and rdm_read_pd() use the compiled format instead of parsing the
+ * format string when they are called with the same format string pointer.
+ * Format strings are stored by pointer; they must not be modified for the
+ * lifetime of the DMX driver. Format strings which are not stored in the DMX
+ * driver are compiled each time they are used.
+ *
+ * @param dmx_num The DMX port number.
+ * @param[in] format The RDM format string.
+ * @return true if the format string was stored.
+ * @return false if the format string is invalid or if there is no space.
+ */
+bool rdm_format_add(dmx_port_t dmx_num, const char *format);
\ No newline at end of file
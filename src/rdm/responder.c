@@ -6,6 +6,7 @@
 #include "dmx/hal/include/uart.h"
 #include "dmx/include/driver.h"
 #include "dmx/include/service.h"
+#include "dmx/trace.h"
 #include "rdm/include/types.h"
 #include "rdm/include/uid.h"
 
@@ -108,6 +109,7 @@ bool rdm_send_response(dmx_port_t dmx_num) {
 
   // Send the RDM response
   if (packet_size > 0) {
+    DMX_TRACE(dmx_num, DMX_TRACE_RDM_RESPONSE, header.pid);
     if (!dmx_send_num(dmx_num, packet_size)) {
       rdm_set_boot_loader(dmx_num);
       // Generate information for the warning message if a response wasn't sent
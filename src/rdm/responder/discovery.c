@@ -8,72 +8,116 @@
 #include "rdm/include/driver.h"
 #include "rdm/include/uid.h"
 
-static size_t rdm_rhd_discovery(dmx_port_t dmx_num,
-                                const rdm_parameter_definition_t *definition,
-                                const rdm_header_t *header) {
+bool rdm_disc_handle_request(rdm_disc_responder_t *responder,
+                             const rdm_header_t *header,
+                             const rdm_disc_unique_branch_t *branch,
+                             rdm_header_t *response) {
+  assert(responder != NULL);
+  assert(header != NULL);
+  assert(header->pid == RDM_PID_DISC_UNIQUE_BRANCH ||
+         header->pid == RDM_PID_DISC_MUTE ||
+         header->pid == RDM_PID_DISC_UN_MUTE);
+  assert(header->pid != RDM_PID_DISC_UNIQUE_BRANCH || branch != NULL);
+  assert(response != NULL);
+
   // Return early if the sub-device is out of range
   if (header->sub_device != RDM_SUB_DEVICE_ROOT) {
-    return 0;  // Cannot respond to RDM_CC_DISC_COMMAND with NACK
+    return false;  // Cannot respond to RDM_CC_DISC_COMMAND with NACK
   }
 
+  size_t pdl;
   if (header->pid == RDM_PID_DISC_UNIQUE_BRANCH) {
     // Return early if this device is muted
-    uint8_t is_muted = 1;  // Don't respond if an error occurs
-    dmx_parameter_copy(dmx_num, RDM_SUB_DEVICE_ROOT, RDM_PID_DISC_MUTE,
-                       &is_muted, sizeof(is_muted));
-    if (is_muted) {
-      return 0;
-    }
-
-    // Get the discovery branch parameters
-    rdm_disc_unique_branch_t branch;
-    if (!rdm_read_pd(dmx_num, definition->get.request.format, &branch,
-                     sizeof(branch))) {
-      return 0;  // Don't send NACK on error
+    if (responder->is_muted) {
+      return false;
     }
 
     // Guard against !(branch.lower_bound <= this_uid <= branch.upper_bound)
-    const rdm_uid_t *this_uid = rdm_uid_get(dmx_num);
-    if (rdm_uid_is_lt(this_uid, &branch.lower_bound) ||
-        rdm_uid_is_gt(this_uid, &branch.upper_bound)) {
-      return 0;  // Request not for this device
+    if (rdm_uid_is_lt(&responder->uid, &branch->lower_bound) ||
+        rdm_uid_is_gt(&responder->uid, &branch->upper_bound)) {
+      return false;  // Request not for this device
     }
 
-    return rdm_write_ack(dmx_num, header, NULL, NULL, 0);
+    pdl = 0;
   } else {
-    // Set or unset the mute parameter
-    const uint8_t set_mute = (header->pid == RDM_PID_DISC_MUTE);
-    dmx_parameter_set(dmx_num, RDM_SUB_DEVICE_ROOT, header->pid, &set_mute,
-                      sizeof(set_mute));
+    // Set or unset the mute flag
+    responder->is_muted = (header->pid == RDM_PID_DISC_MUTE);
+    pdl = sizeof(responder->mute);
+  }
 
+  // Build the response header
+  *response = (rdm_header_t){
+      .message_len = 24 + pdl,
+      .dest_uid = header->src_uid,
+      .src_uid = responder->uid,
+      .tn = header->tn,
+      .response_type = RDM_RESPONSE_TYPE_ACK,
+      .message_count = 0,
+      .sub_device = header->sub_device,
+      .cc = (header->cc | 0x1),  // Set to RDM_CC_DISC_COMMAND_RESPONSE
+      .pid = header->pid,
+      .pdl = pdl};
+
+  return true;
+}
+
+static size_t rdm_rhd_discovery(dmx_port_t dmx_num,
+                                const rdm_parameter_definition_t *definition,
+                                const rdm_header_t *header) {
+  // Get the discovery state of this device
+  rdm_disc_responder_t responder = {.is_muted = 1};  // Don't respond on error
+  memcpy(&responder.uid, rdm_uid_get(dmx_num), sizeof(responder.uid));
+  dmx_parameter_copy(dmx_num, RDM_SUB_DEVICE_ROOT, RDM_PID_DISC_MUTE,
+                     &responder.is_muted, sizeof(responder.is_muted));
+
+  rdm_disc_unique_branch_t branch;
+  if (header->pid == RDM_PID_DISC_UNIQUE_BRANCH) {
+    // Get the discovery branch parameters
+    if (!responder.is_muted &&
+        !rdm_read_pd(dmx_num, definition->get.request.format, &branch,
+                     sizeof(branch))) {
+      return 0;  // Don't send NACK on error
+    }
+  } else {
     // Get the binding UID of this device
     int num_ports = 0;
-    rdm_disc_mute_t mute;
+    rdm_disc_mute_t *mute = &responder.mute;
     for (int i = 0; i < DMX_NUM_MAX; ++i) {
       if (dmx_driver_is_installed(i)) {
         ++num_ports;
       }
     }
     if (num_ports == 1) {
-      mute.binding_uid = (rdm_uid_t){0, 0};  // Don't report a binding UID
+      mute->binding_uid = (rdm_uid_t){0, 0};  // Don't report a binding UID
     } else {
       for (int i = 0; i < DMX_NUM_MAX; ++i) {
         if (dmx_driver_is_installed(i)) {
-          memcpy(&mute.binding_uid, rdm_uid_get(i), sizeof(mute.binding_uid));
+          memcpy(&mute->binding_uid, rdm_uid_get(i), sizeof(mute->binding_uid));
           break;
         }
       }
     }
 
     // Get the mute control field of this port
-    mute.managed_proxy = 0;  // TODO: managed proxy flag
-    mute.sub_device = dmx_sub_device_get_count(dmx_num) > 0 ? 1 : 0;
-    mute.boot_loader = rdm_get_boot_loader(dmx_num);
-    mute.proxied_device = 0;  // TODO: proxied device flag
+    mute->managed_proxy = 0;  // TODO: managed proxy flag
+    mute->sub_device = dmx_sub_device_get_count(dmx_num) > 0 ? 1 : 0;
+    mute->boot_loader = rdm_get_boot_loader(dmx_num);
+    mute->proxied_device = 0;  // TODO: proxied device flag
+  }
 
-    return rdm_write_ack(dmx_num, header, definition->get.response.format,
-                         &mute, sizeof(mute));
+  rdm_header_t response;
+  if (!rdm_disc_handle_request(&responder, header, &branch, &response)) {
+    return 0;
   }
+
+  // Store the mute flag of this device
+  if (header->pid != RDM_PID_DISC_UNIQUE_BRANCH) {
+    dmx_parameter_set(dmx_num, RDM_SUB_DEVICE_ROOT, header->pid,
+                      &responder.is_muted, sizeof(responder.is_muted));
+  }
+
+  response.message_count = rdm_queue_size(dmx_num);
+  return rdm_write(dmx_num, &response, RDM_DISC_MUTE_FORMAT, &responder.mute);
 }
 
 bool rdm_register_disc_unique_branch(dmx_port_t dmx_num, rdm_callback_t cb,
@@ -139,7 +183,7 @@ bool rdm_register_disc_mute(dmx_port_t dmx_num, rdm_callback_t cb,
       .ds = RDM_DS_NOT_DEFINED,
       .get = {.handler = rdm_rhd_discovery,
               .request.format = NULL,
-              .response.format = "wv"},
+              .response.format = RDM_DISC_MUTE_FORMAT},
       .set = {.handler = NULL, .request.format = NULL, .response.format = NULL},
       .pdl_size = 0,
       .max_value = 0,
@@ -182,7 +226,7 @@ bool rdm_register_disc_un_mute(dmx_port_t dmx_num, rdm_callback_t cb,
       .ds = RDM_DS_NOT_DEFINED,
       .get = {.handler = rdm_rhd_discovery,
               .request.format = NULL,
-              .response.format = "wv"},
+              .response.format = RDM_DISC_MUTE_FORMAT},
       .set = {.handler = NULL, .request.format = NULL, .response.format = NULL},
       .pdl_size = 0,
       .max_value = 0,
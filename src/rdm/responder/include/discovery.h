@@ -17,6 +17,42 @@
 extern "C" {
 #endif
 
+/** @brief The parameter data format of RDM_PID_DISC_MUTE and
+ * RDM_PID_DISC_UN_MUTE responses.*/
+#define RDM_DISC_MUTE_FORMAT "wv"
+
+/**
+ * @brief The state of an RDM responder which is needed to respond to RDM
+ * discovery requests. The DMX driver fills it from its parameters for each
+ * request. Emulated responders keep one for each responder.
+ */
+typedef struct rdm_disc_responder_t {
+  rdm_uid_t uid;     // The UID of the responder.
+  uint8_t is_muted;  // Non-zero if the responder is muted.
+  rdm_disc_mute_t mute;  // The control field and binding UID sent when muted.
+} rdm_disc_responder_t;
+
+/**
+ * @brief Handles an RDM_PID_DISC_UNIQUE_BRANCH, RDM_PID_DISC_MUTE, or
+ * RDM_PID_DISC_UN_MUTE request on behalf of a responder. The mute flag of the
+ * responder is updated and the header of the response is built. The response
+ * parameter data is the mute field of the responder, encoded with
+ * RDM_DISC_MUTE_FORMAT. Responses to RDM_PID_DISC_UNIQUE_BRANCH have no
+ * parameter data.
+ *
+ * @param[inout] responder A pointer to the state of the responder.
+ * @param[in] header A pointer to the header of the request.
+ * @param[in] branch A pointer to the parameter data of an
+ * RDM_PID_DISC_UNIQUE_BRANCH request. Unused for other requests.
+ * @param[out] response A pointer into which to write the response header.
+ * @return true if the responder must send a response.
+ * @return false if the responder must not respond.
+ */
+bool rdm_disc_handle_request(rdm_disc_responder_t *responder,
+                             const rdm_header_t *header,
+                             const rdm_disc_unique_branch_t *branch,
+                             rdm_header_t *response);
+
 /**
  * @brief Registers the default response to RDM_PID_DISC_UNIQUE_BRANCH requests.
  * This response is required by all RDM-capable devices. It is called when the
@@ -11,7 +11,6 @@ size_t rdm_write_ack(dmx_port_t dmx_num, const rdm_header_t *header,
   assert(dmx_num < DMX_NUM_MAX);
   assert(header != NULL);
   assert(rdm_cc_is_request(header->cc));
-  assert(rdm_format_is_valid(format));
   assert(format != NULL || pd == NULL);
   assert(pd != NULL || pdl == 0);
   assert(pdl < 231);
@@ -177,6 +176,20 @@ bool rdm_definition_set(dmx_port_t dmx_num, rdm_sub_device_t sub_device,
 
   entry->definition = definition;
 
+  // Compile the format strings so they don't need to be parsed per packet
+  const char *formats[] = {
+      definition->get.request.format, definition->get.response.format,
+      definition->set.request.format, definition->set.response.format};
+  for (int i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+    if (!rdm_format_add(dmx_num, formats[i])) {
+      DMX_WARN(
+          "RDM format cache is full, PID 0x%04x is parsed for every packet. "
+          "Increase CONFIG_RDM_FORMAT_CACHE_SIZE",
+          pid);
+      break;
+    }
+  }
+
   return true;
 }
 